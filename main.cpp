@@ -1,5 +1,6 @@
 
 #include "util/graphs.hpp"
+#include "util/graph_io.hpp"
 #include "util/statistics.hpp"
 #include "reduction/trr.hpp"
 #include "reduction/prr.hpp"
@@ -8,13 +9,29 @@
 #include "solv/verify.hpp"
 #include "solv/solv_opts.hpp"
 #include "math.h"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
 
 void usage(const char* progname, std::ostream& o){
-  o << "usage: " << progname << " file <file to read> [more opts]" << std::endl;
+  o << "usage: " << progname << " file <file to read> [more opts]\t read pairs of vertex names, PACE, DIMACS, METIS or binary graphs (detected from the header)" << std::endl;
   o << "       " << progname << " rand <vertices> <additional edges> [more opts]"<< std::endl;
+  o << "       " << progname << " convert <file to read> <file to write>\t store the graph in the binary format, which loads without parsing"<< std::endl;
+  o << "       " << progname << " bench <max edges>\t time the graph traversals on layered graphs of up to <max edges> edges"<< std::endl;
+  o << "       " << progname << " batch <list file|directory> [more opts]\t solve each file listed (one per line) or in the directory, printing one line per file"<< std::endl;
   o << "more opts: " << " -lbmod x\t <int>\t apply slower (more powerful) lower bound each x layers (def: "<<cr::default_opts.slow_lower_bound_layers_wait<<")"<< std::endl;
   o << "           " << " -BB x\t {0,1}\t control application of Bbridge branching rule (0=no, 1=yes) (def: "<<cr::default_opts.use_Bbridge_rule <<")"<<std::endl;
   o << "           " << " -YL x\t <int>\t perform Y-lookahead if G has fewer than x vertices (def: "<< cr::default_opts.max_size_for_Y_lookahead<<")"<< std::endl;
+  o << "           " << " -RN x\t <int>\t renumber the vertices of G for locality up to search depth x, -1 = never (def: "<< cr::default_opts.renumber_max_depth<<")"<< std::endl;
+  o << "           " << " -BS x\t <int>\t solve components of at most x vertices on bitsets (at most "<< cr::bitset_max_useful_vertices<<"), 0 = never (def: "<< cr::default_opts.bitset_max_vertices<<")"<< std::endl;
+  o << "           " << " -BJ x\t <int>\t batch: solve x files at the same time, 0 = one per core (def: 0)"<< std::endl;
+  o << "           " << " -BT x\t <float>\t batch: give up on a file after x seconds, 0 = never (def: 0)"<< std::endl;
+  o << "           " << " -BO x\t {0,1}\t batch: print the files in the order of the list (0) or as they are solved (1) (def: 0)"<< std::endl;
   exit(1);
 }
 
@@ -38,14 +55,217 @@ void get_random_graph(cr::graph& g, const size_t num_vertices, const size_t num_
       success = (g.add_edge_secure(v, verts[(size_t)round(((double)(num_vertices-1) * random()) / RAND_MAX)]) == v->adj_list.end());
     } while(!success);
   }
+  g.set_as_input();
+}
+
+// layered graph with about m edges, looking like a layered drawing: 4 long chains, each layer connected in a cycle,
+// and a pendant path of length 3 at every 100th vertex (so the graph has bridges and leaves)
+void get_layered_graph(cr::graph& g, const size_t m){
+  const size_t width = 4;
+  const size_t layers = std::max<size_t>(m / (2 * width + 3 * width / 100.0), 2);
+  std::vector<cr::vertex_p> prev_layer, layer(width);
+  for(size_t i = 0; i < layers; ++i){
+    for(size_t j = 0; j < width; ++j){
+      layer[j] = g.add_vertex_fast();
+      if(j) g.add_edge_fast(layer[j - 1], layer[j]);
+      if(!prev_layer.empty()) g.add_edge_fast(prev_layer[j], layer[j]);
+      if((i * width + j) % 100 == 0){
+        cr::vertex_p v(layer[j]);
+        for(uint k = 0; k < 3; ++k){
+          const cr::vertex_p w(g.add_vertex_fast());
+          g.add_edge_fast(v, w);
+          v = w;
+        }
+      }
+    }
+    g.add_edge_fast(layer[width - 1], layer[0]);
+    prev_layer = layer;
+  }
+}
+
+// time the bridge finder and TRR6 on layered graphs with 10^3, 10^4, ... edges
+// the throughput (edges per second) should not degrade with the size of the graph
+void run_scale_benchmark(const size_t max_edges){
+  typedef std::chrono::steady_clock clock;
+  std::cout << "edges\tvertices\tbridges\tbridges(s)\tMedges/s\tTRR6(s)\tMedges/s" << std::endl;
+  for(size_t m = 1000; m <= max_edges; m *= 10){
+    cr::instance I;
+    get_layered_graph(I.g, m);
+    const size_t edges = I.g.edgenum;
+    const size_t verts = I.g.vertices.size();
+
+    const clock::time_point start(clock::now());
+    const size_t bridges = I.g.get_bridges().size();
+    const clock::time_point middle(clock::now());
+    cr::trr6(I);
+    const clock::time_point end(clock::now());
+
+    const double t_bridges = std::chrono::duration<double>(middle - start).count();
+    const double t_trr6 = std::chrono::duration<double>(end - middle).count();
+    std::cout << edges << "\t" << verts << "\t" << bridges << "\t" << t_bridges << "\t" << edges / t_bridges / 1e6
+      << "\t" << t_trr6 << "\t" << edges / t_trr6 / 1e6 << std::endl;
+  }
+}
+
+// read g from the file, giving up on malformed input
+void read_input(cr::graph& g, const char* file){
+  try{
+    g.read_from_file(file);
+  } catch(const cr::input_error& e) {FAIL(file << ": " << e.what());}
+}
+
+enum solve_result {solved, timed_out, not_verified};
+
+// solve I (which is fresh from the input) and verify the solution, keeping statistics in stats
+// if opts.deadline passed before we were done or the solution did not verify, then sol is useless
+solve_result solve_instance(cr::instance& I, const cr::solv_options& opts, cr::stats_t& stats, cr::solution_t& sol){
+  I.k = INT_MAX;
+
+  //cout <<"Options: " << endl << opts << endl;
+
+
+  // get an upper bound on k to start with
+  cr::solution_t upper_bound(upper_bound_simple(I));
+  I.k = upper_bound.size();
+
+/*
+  std::cout << "prior to  TRRs: " << I.g.vertices.size() << " vertices and " << I.g.edgenum << " edges" << std::endl;
+  sol += apply_trrs(I);
+
+  std::cout << "after TRRs: " << std::endl;
+  I.g.write_to_stream(std::cout);
+
+  sol += apply_prrs(I);
+
+  std::cout << "after PRRs: " << std::endl;
+  I.g.write_to_stream(std::cout);
+
+  std::list<cr::edge_p> bridgelist = I.g.get_bridges();
+
+  uint verts = I.g.vertices.size();
+  uint edges = I.g.edgenum;
+  uint ccs = I.g.cc_number;
+  uint lower_bound = cr::compute_lower_bound(I.g);
+
+  std::cout << "stats: |V|: "<<verts<<" |E|: "<<edges<<" #cc: "<<ccs<<" FES: "<<ccs+edges-verts<<" bridges: "<<bridgelist.size()<<" lowerbound: "<<lower_bound<<std::endl;
+*/
+  stats.input_FES=cr::get_FES(I.g);
+  // the verification rebuilds the input graph from the input infos, so we neither keep a copy of I nor undo what the
+  // algorithm does to it
+  sol += cr::run_branching_algo(I, stats, opts);
+  if(opts.out_of_time()) return timed_out;
+
+  //std::cout << "verifying size-"<<sol.size()<<" solution " << sol << endl;
+  // the verification runs against the same deadline, and if it passes there, we could not verify in time
+  if(verify_solution(I, sol, opts.deadline)) return solved;
+  return opts.out_of_time() ? timed_out : not_verified;
+}
+
+// the files to solve in batch mode: the files in the directory (sorted by name) or the lines of the list file
+std::vector<string> get_batch_files(const string& source){
+  std::vector<string> files;
+  struct stat st;
+  if((stat(source.c_str(), &st) == 0) && S_ISDIR(st.st_mode)){
+    DIR* const dir(opendir(source.c_str()));
+    if(!dir) FAIL("could not open directory "<<source);
+    for(const dirent* entry = readdir(dir); entry; entry = readdir(dir)){
+      const string path(source + "/" + entry->d_name);
+      if((entry->d_name[0] != '.') && (stat(path.c_str(), &st) == 0) && S_ISREG(st.st_mode)) files.push_back(path);
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+  } else {
+    std::ifstream list(source.c_str());
+    if(!list) FAIL("could not open "<<source);
+    for(string line; std::getline(list, line);){
+      const size_t first(line.find_first_not_of(" \t\r"));
+      if(first != string::npos) files.push_back(line.substr(first, line.find_last_not_of(" \t\r") + 1 - first));
+    }
+  }
+  return files;
+}
+
+// solve all files of the batch with a pool of workers, each reusing its instance and statistics from file to file
+// for each file, print its name, the solution size (or "timeout" or "error" if the solution did not verify), the seconds
+// it took to read and solve it, and its statistics as output_parser_friendly() does
+// a file that cannot be read (it is malformed, too large for memory, ...) gets "unreadable" and the reason instead
+void run_batch(const string& source, cr::solv_options opts, uint workers, const double timeout, const bool as_solved){
+  typedef std::chrono::steady_clock clock;
+  const std::vector<string> files(get_batch_files(source));
+  const uint cores(std::max(std::thread::hardware_concurrency(), 1u));
+  if(workers == 0) workers = cores;
+  workers = std::min<size_t>(workers, files.size());
+  // the workers share the cores for reading as well
+  const uint reader_threads(std::max(cores / std::max(workers, 1u), 1u));
+
+  std::atomic<size_t> next_file(0);
+  std::mutex output_mutex;
+  std::condition_variable output_ready;
+  // if we print in the order of the list, then the workers leave their lines here
+  std::vector<string> lines(files.size());
+  std::vector<bool> done(files.size(), false);
+
+  auto work = [&](){
+    cr::instance I;
+    cr::stats_t stats;
+    cr::solution_t sol;
+    cr::solv_options my_opts(opts);
+    for(size_t i = next_file++; i < files.size(); i = next_file++){
+      std::ostringstream line;
+      line << files[i] << '\t';
+      const clock::time_point start(clock::now());
+      string error;
+      if(!std::ifstream(files[i].c_str())) error = "cannot open file"; else
+        try{
+          I.g.read_from_file(files[i].c_str(), reader_threads);
+        } catch(const std::exception& e) {error = e.what();}
+      if(!error.empty()) line << "unreadable\t" << error << std::endl; else {
+        stats.clear();
+        sol.clear();
+        my_opts.deadline = (timeout > 0) ? start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(timeout))
+                                         : clock::time_point::max();
+        switch(solve_instance(I, my_opts, stats, sol)){
+          case solved: line << sol.size(); break;
+          case timed_out: line << "timeout"; break;
+          case not_verified: line << "error"; break;
+        }
+        line << '\t' << std::chrono::duration<double>(clock::now() - start).count() << '\t';
+        output_parser_friendly(line, stats);
+      }
+      std::lock_guard<std::mutex> lock(output_mutex);
+      if(as_solved) std::cout << line.str() << std::flush; else {
+        lines[i] = line.str();
+        done[i] = true;
+        output_ready.notify_one();
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for(uint t = 0; t < workers; ++t) pool.push_back(std::thread(work));
+  if(!as_solved)
+    for(size_t i = 0; i < files.size(); ++i){
+      std::unique_lock<std::mutex> lock(output_mutex);
+      output_ready.wait(lock, [&](){return done[i];});
+      std::cout << lines[i] << std::flush;
+      string().swap(lines[i]);
+    }
+  for(std::thread& t : pool) t.join();
 }
 
 const std::pair<string, int> _requires_params[] = {
   { "file", 1 },
   { "rand",  2 },
+  { "bench", 1 },
+  { "convert", 2 },
+  { "batch", 1 },
   { "-lbmod", 1 },
   { "-BB", 1 },
-  { "-YL", 1 }
+  { "-YL", 1 },
+  { "-RN", 1 },
+  { "-BS", 1 },
+  { "-BJ", 1 },
+  { "-BT", 1 },
+  { "-BO", 1 }
 };
 // global arguments with their parameters
 std::map<string, std::vector<string> > arguments;
@@ -79,53 +299,40 @@ int main(int argc, char** argv)
   // parse the arguments, filling 'arguments'
   parse_args(argc, argv, I, opts);
 
-  if(arguments.find("rand") != arguments.end())
-    get_random_graph(I.g, stoi(arguments["rand"][0]), stoi(arguments["rand"][1]));
-  else if(arguments.find("file") != arguments.end()) I.g.read_from_file(arguments["file"][0].c_str());
-  else usage(argv[0], std::cerr);
+  if(arguments.find("bench") != arguments.end()){
+    run_scale_benchmark(stoul(arguments["bench"][0]));
+    return 0;
+  }
+  if(arguments.find("convert") != arguments.end()){
+    read_input(I.g, arguments["convert"][0].c_str());
+    std::ofstream out(arguments["convert"][1].c_str(), std::ios::binary);
+    cr::write_binary(I.g, out);
+    if(!out) FAIL("could not write "<<arguments["convert"][1]);
+    return 0;
+  }
   if(arguments.find("-lbmod") != arguments.end()) opts.slow_lower_bound_layers_wait = stoi(arguments["-lbmod"][0]);
   if(arguments.find("-BB") != arguments.end()) opts.use_Bbridge_rule = stoi(arguments["-BB"][0]);
   if(arguments.find("-YL") != arguments.end()) opts.max_size_for_Y_lookahead = stoi(arguments["-YL"][0]);
-  I.k = INT_MAX;
-
-  //cout <<"Options: " << endl << opts << endl;
-
-
-  // get an upper bound on k to start with
-  cr::solution_t upper_bound(upper_bound_simple(I));
-  I.k = upper_bound.size();
-
-  cr::instance Iprime(I);
-
-/*
-  std::cout << "prior to  TRRs: " << I.g.vertices.size() << " vertices and " << I.g.edgenum << " edges" << std::endl;
-  sol += apply_trrs(I);
-
-  std::cout << "after TRRs: " << std::endl;
-  I.g.write_to_stream(std::cout);
-
-  sol += apply_prrs(I);
-
-  std::cout << "after PRRs: " << std::endl;
-  I.g.write_to_stream(std::cout);
-
-  std::list<cr::edge_p> bridgelist = I.g.get_bridges();
-
-  uint verts = I.g.vertices.size();
-  uint edges = I.g.edgenum;
-  uint ccs = I.g.cc_number;
-  uint lower_bound = cr::compute_lower_bound(I.g);
+  if(arguments.find("-RN") != arguments.end()) opts.renumber_max_depth = stoi(arguments["-RN"][0]);
+  if(arguments.find("-BS") != arguments.end()) opts.bitset_max_vertices = stoi(arguments["-BS"][0]);
+  if(arguments.find("batch") != arguments.end()){
+    run_batch(arguments["batch"][0], opts,
+              (arguments.find("-BJ") != arguments.end()) ? stoi(arguments["-BJ"][0]) : 0,
+              (arguments.find("-BT") != arguments.end()) ? stod(arguments["-BT"][0]) : 0,
+              (arguments.find("-BO") != arguments.end()) && stoi(arguments["-BO"][0]));
+    return 0;
+  }
+  if(arguments.find("rand") != arguments.end())
+    get_random_graph(I.g, stoi(arguments["rand"][0]), stoi(arguments["rand"][1]));
+  else if(arguments.find("file") != arguments.end()) read_input(I.g, arguments["file"][0].c_str());
+  else usage(argv[0], std::cerr);
 
-  std::cout << "stats: |V|: "<<verts<<" |E|: "<<edges<<" #cc: "<<ccs<<" FES: "<<ccs+edges-verts<<" bridges: "<<bridgelist.size()<<" lowerbound: "<<lower_bound<<std::endl;
-*/
   cr::stats_t stats;
-  stats.input_FES=cr::get_FES(I.g);
-  sol += cr::run_branching_algo(I, stats, opts);
-
-  //std::cout << "verifying size-"<<sol.size()<<" solution " << sol << endl;
-  if(! verify_solution(Iprime, sol)) {cout << "======= EPIC FAIL: VERIFICATION FAILED ======" << endl; exit(1);}
+  if(solve_instance(I, opts, stats, sol) == not_verified) FAIL("======= EPIC FAIL: VERIFICATION FAILED ======");
 
-  std::cout << "solution: "<< sol << " size: "<<sol.size()<<std::endl;
+  std::cout << "solution: ";
+  I.g.write_solution(std::cout, sol);
+  std::cout << " size: "<<sol.size()<<std::endl;
   std::cerr << stats <<std::endl;
   output_parser_friendly(cout, stats);
 }
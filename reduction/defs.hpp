@@ -6,6 +6,7 @@ namespace cr {
 }
 
 
+namespace cr{
 inline ostream& operator<<(ostream& os, const cr::reduction_type& t){
   switch(t){
     case cr::TRR1: os <<"T1"; break;
@@ -27,7 +28,6 @@ inline ostream& operator<<(ostream& os, const cr::reduction_type& t){
   }
   return os;
 }
-
-
+}
 
 #endif
@@ -15,7 +15,7 @@ namespace cr {
     // if v has nldeg > 2, then v is not splittable
     if(v->nldeg() > 2) return false;
     // if any of v's neighbors has nldeg > 2, then v is not splittable
-    for(list<edge>::const_iterator w = v->adj_list.begin(); w != v->adj_list.end(); ++w)
+    for(edge_pc w = v->adj_list.begin(); w != v->adj_list.end(); ++w)
       if(w->head->nldeg() > 2) return false;
     return true;
   }
@@ -27,9 +27,10 @@ namespace cr {
     const vertex_p& u(b->get_tail());
     // delete the bridge
     // and add a new deg-1 neighbor to u
-    const vertex_p vprime(I.g.add_vertex_fast(v->name + '\''));
+    const vertex_p vprime(I.g.add_vertex_fast(v->name));
     DEBUG2(cout << "replacing "<<b<<" by the new edge ("<<vprime<<", "<<u<<")"<<endl);
-    I.g.add_edge_fast(vprime, u);
+    // the new edge takes the place of b, so it represents the same input edge
+    I.g.add_edge_fast(vprime, u, b->input_id);
     I.g.delete_edge(b);
     // apply TRRs from vprime upwards
   }
@@ -178,20 +179,24 @@ namespace cr {
   // recurse for a specific pendant to be hung to v
   solution_t recurse_for(instance& Ismall,
                          const vertex_p v,
-                         void (*modify)(graph&, const vertex_p&, const string&),
+                         void (*modify)(graph&, const vertex_p&, const uint),
                          stats_t& stat,
                          const solv_options& solv_opts,
                          const uint depth)
   {
-    // 1. copy instance
-    unordered_map<uint, vertex_p> id_to_vertex;
-    instance J(Ismall, &id_to_vertex);
+    // 1. take a checkpoint of the instance
+    Ismall.g.checkpoint();
+    const int k = Ismall.k;
     // 2. modify instance
-    modify(J.g, id_to_vertex[v->id], v->name);
+    modify(Ismall.g, v, v->name);
     // 3. recurse
-    DEBUG2(cout << "recursing for "<<J.g<<endl);
-    solution_t S(run_branching_algo(J, stat, solv_opts, depth+1));
-    if(J.g.vertices.empty() && (J.k >= 0)) return S; else return solution_t();
+    DEBUG2(cout << "recursing for "<<Ismall.g<<endl);
+    solution_t S(run_branching_algo(Ismall, stat, solv_opts, depth+1));
+    const bool success(Ismall.g.vertices.empty() && (Ismall.k >= 0));
+    // 4. and undo everything
+    Ismall.g.rollback();
+    Ismall.k = k;
+    if(success) return S; else return solution_t();
   }
 
   // Note: technically, this is not a reduction rule, but a branching rule. Hence, we'll need the solv_options
@@ -244,21 +249,18 @@ namespace cr {
     // 0. get G[X]
     const vertex_p u(uv->get_tail());
     vertex_p v(uv->head);
-    const uint v_id(v->id);
+    DEBUG1(const uint v_id(v->id))
     const bool uv_was_permanent(uv->is_permanent);
+    const uint uv_input_id(uv->input_id);
 
 
     // delete uv
     I.g.delete_edge(uv);  // from here, the component containing v is smaller than the other one
     // extract the component containing v as Ismall
     instance Ismall;
-    unordered_map<uint, vertex_p>* id_to_vertex = new unordered_map<uint, vertex_p>();
-    I.g.copy_component(v, Ismall.g, id_to_vertex);
-    DEBUG1(cout << "got translation matrix "<<*id_to_vertex<<" & looking for "<<v<<" (id: "<<v->id<<")"<<endl);
-    I.g.delete_component(v);
-    v = id_to_vertex->at(v_id);
+    v = I.g.move_component(v, Ismall.g);
+    DEBUG1(cout << "moved the component of "<<v_id<<" to Ismall, where it's "<<v<<endl);
     Ismall.k = I.k;
-    delete id_to_vertex;
 
     // start computing S1,..,S4
     solution_t S1, S2, S3, S4;
@@ -281,7 +283,7 @@ namespace cr {
       S1 = recurse_for(Ismall, v, &add_nothing, stat, solv_opts, depth);
       DEBUG2(cout << "Step 1: got solution S1 = "<<S1<<endl);
       if(!S1.empty()){
-        S1 += u->name + "->" + v->name;
+        S1 += uv_input_id;
         I.k -= S1.size();
         DEBUG2(cout << "Step 1: continuing to solve the rest with S1 = "<<S1<<" and remaining k = "<<I.k<<endl);
         S1 += run_branching_algo(I, stat, solv_opts, depth+1);
@@ -421,20 +423,27 @@ namespace cr {
       if(cyc_v_deg < upper_bound)
         return false;
       else if(cyc_v_deg == upper_bound){
-        // make a copy I' of I
-        unordered_map<uint, vertex_p> id_to_vertex;
-        instance Iprime(I, &id_to_vertex);
-        const vertex_p vprime(id_to_vertex[v->id]);
-        const vertex_p wprime(id_to_vertex[v->trr_infos.ygraphs.front()->head->id]);
-        // delete N(v) - Y from I'
-        for(edge_p f = vprime->adj_list.begin(); f != vprime->adj_list.end();) if(f->head == wprime) ++f; else
-          Iprime.g.delete_edge(f++);
+        // trr6 marks vertices with a fresh dfs_id, but our caller might rely on its own markings
+        vector<uint> dfs_ids;
+        dfs_ids.reserve(I.g.vertices.size());
+        for(vertex_p u = I.g.vertices.begin(); u != I.g.vertices.end(); ++u) dfs_ids.push_back(u->dfs_id);
+        // instead of copying I, modify it in place and roll back afterwards
+        I.g.checkpoint();
+        const vertex_p w(v->trr_infos.ygraphs.front()->head);
+        // delete N(v) - Y from I
+        for(edge_p f = v->adj_list.begin(); f != v->adj_list.end();) if(f->head == w) ++f; else
+          f = I.g.delete_edge(f);
         // see if this solved the instance
-        trr6(Iprime);
+        trr6(I);
+        const bool solved(I.g.vertices.empty());
+        I.g.rollback();
+        vector<uint>::const_iterator id(dfs_ids.begin());
+        for(vertex_p u = I.g.vertices.begin(); u != I.g.vertices.end(); ++u) u->dfs_id = *id++;
         // if not, delete vw in I
-        if(!Iprime.g.vertices.empty()){
+        if(!solved){
           DEBUG2(cout << "This is YL for "<<v<<" with upper bound "<<upper_bound<<endl);
           I.delete_edge(v->trr_infos.ygraphs.front(), sol);
+          v->save_state();
           v->trr_infos.ygraphs.pop_front();
           DO_STAT(stat.reduct_application[YL]++);
           return true;
@@ -443,6 +452,7 @@ namespace cr {
         DEBUG2(cout << "This is YL for "<<v<<" with upper bound "<<upper_bound<<endl);
         // here, cyc_v_deg > upper_bound, so delete vw
         I.delete_edge(v->trr_infos.ygraphs.front(), sol);
+        v->save_state();
         v->trr_infos.ygraphs.pop_front();
         DO_STAT(stat.reduct_application[YL]++);
         return true;
@@ -6,12 +6,13 @@
 namespace cr{
 
   // add a leaf to v, keeping trr_infos up to date; returns edge to the new leaf
-  edge_p& copy_leaf(graph& g, const vertex_p& v, const vertex_p& leaf){
+  edge_p copy_leaf(graph& g, const vertex_p& v, const edge_p& to_leaf){
+    const vertex_p& leaf(to_leaf->head);
     // create the vertex
-    const vertex_p new_leaf(g.add_vertex_fast(leaf->name + '\''));
+    const vertex_p new_leaf(g.add_vertex_fast(leaf->name));
     new_leaf->dfs_id = leaf->dfs_id;
     // connect it to v
-    const edge_p to_v(g.add_edge_fast(new_leaf, v));
+    const edge_p to_v(g.add_edge_fast(new_leaf, v, to_leaf->input_id));
 
     // register the new leaf in the trr_infos (subtree NH)
     update_trr_infos_from_child(to_v);
@@ -21,15 +22,16 @@ namespace cr{
   }
 
   // add a P2 to v keeping trr_infos up to date; return edge to the center vertex
-  edge_p& copy_P2(graph& g, const vertex_p& v, const vertex_p& center){
+  edge_p copy_P2(graph& g, const vertex_p& v, const edge_p& to_center){
+    const vertex_p& center(to_center->head);
     // create the vertex
-    const vertex_p new_center(g.add_vertex_fast(center->name + '\''));
+    const vertex_p new_center(g.add_vertex_fast(center->name));
     new_center->dfs_id = center->dfs_id;
     // create a new leaf at the center
-    for(edge_pp leaf = center->trr_infos.leaves.begin(); leaf != center->trr_infos.leaves.end(); ++leaf)
-      copy_leaf(g, new_center, (*leaf)->head);
+    for(const edge_p leaf : center->trr_infos.leaves)
+      copy_leaf(g, new_center, leaf);
     // connect the new center to v
-    const edge_p to_v(g.add_edge_fast(new_center, v));
+    const edge_p to_v(g.add_edge_fast(new_center, v, to_center->input_id));
     // update the trr_infos of v
     update_trr_infos_from_child(to_v);
     // and return edge to the new center
@@ -37,17 +39,18 @@ namespace cr{
   }
 
   // add a Y graph to v keeping trr_infos up to date; return edge to the center vertex
-  edge_p& copy_Y(graph& g, const vertex_p& v, const vertex_p& center){
-    const vertex_p new_center(g.add_vertex_fast(center->name + '\''));
+  edge_p copy_Y(graph& g, const vertex_p& v, const edge_p& to_center){
+    const vertex_p& center(to_center->head);
+    const vertex_p new_center(g.add_vertex_fast(center->name));
     new_center->dfs_id = center->dfs_id;
     // copy a leaf if there is one at center
-    for(edge_pp leaf = center->trr_infos.leaves.begin(); leaf != center->trr_infos.leaves.end(); ++leaf)
-      copy_leaf(g, new_center, (*leaf)->head);
+    for(const edge_p leaf : center->trr_infos.leaves)
+      copy_leaf(g, new_center, leaf);
     // copy all P2's that are at center
-    for(edge_pp ptwo = center->trr_infos.ptwos.begin(); ptwo != center->trr_infos.ptwos.end(); ++ptwo)
-      copy_P2(g, new_center, (*ptwo)->head);
+    for(const edge_p ptwo : center->trr_infos.ptwos)
+      copy_P2(g, new_center, ptwo);
     // connect the new center to v
-    const edge_p to_v(g.add_edge_fast(new_center, v));
+    const edge_p to_v(g.add_edge_fast(new_center, v, to_center->input_id));
     // update the trr_infos of v
     update_trr_infos_from_child(to_v);
     // and return edge to the new center
@@ -57,13 +60,13 @@ namespace cr{
   // copy v's complete pendant tree to vprime (including dfs_id's)
   void copy_pendant(graph& g, const vertex_p& v, const vertex_p& vprime){
     // step 1: copy leaves
-    for(edge_p e : v->trr_infos.leaves) copy_leaf(g, vprime, e->head);
+    for(edge_p e : v->trr_infos.leaves) copy_leaf(g, vprime, e);
     
     // step 2: copy P2s
-    for(edge_p e : v->trr_infos.ptwos) copy_P2(g, vprime, e->head);
+    for(edge_p e : v->trr_infos.ptwos) copy_P2(g, vprime, e);
 
     // step 3: copy Ys
-    for(edge_p e : v->trr_infos.ygraphs) copy_Y(g, vprime, e->head);
+    for(edge_p e : v->trr_infos.ygraphs) copy_Y(g, vprime, e);
   }
 
 
@@ -176,6 +179,7 @@ namespace cr{
     const vertex_p w(e->head);
 
     // remove the Ygraph from v's trr_infos
+    v->save_state();
     v->trr_infos.ygraphs.pop_front();
 
     // kill the edge to the center of v's Y-graph
@@ -218,7 +222,7 @@ namespace cr{
       }
     } else {
       // else skip over v by {u,w} and update u and w (could have become separators)
-      sol += v->name + "->?";
+      sol += no_index;
       I.k--;
 
       // remember if we need to update start/end of the path
@@ -241,9 +245,11 @@ namespace cr{
 
       // obstrusify u & w if they are on the deg-2 path, so verification is possible
       // because if (3) matched, then the solution actually has to be transformed,
-      // although the size is the same
-      if(u->cyc_core_degree() == 2) u->name += '*';
-      if(w->cyc_core_degree() == 2) w->name += '*';
+      // although the size is the same: their edges no longer stand for input edges
+      if(u->cyc_core_degree() == 2)
+        for(edge_p f = u->adj_list.begin(); f != u->adj_list.end(); ++f) f->set_input_id(no_index);
+      if(w->cyc_core_degree() == 2)
+        for(edge_p f = w->adj_list.begin(); f != w->adj_list.end(); ++f) f->set_input_id(no_index);
 
       // set the separator if any of the two has become one
       if(u->is_separator()) info.separators.insert(u); else info.separators.erase(u);
@@ -270,6 +276,7 @@ namespace cr{
       const vertex_p& v(info.end->head);
       if(!u->is_on_backbone()) { add_leaf(I.g, u); sol += perform_trrs(I, stat, u); }
       if(!v->is_on_backbone()) { add_leaf(I.g, v); sol += perform_trrs(I, stat, v); }
+      return false;
     } else{
       if(info.start->get_tail() == info.end->head){
         const vertex_p v(info.end->head);
@@ -330,11 +337,12 @@ namespace cr{
     const edge_p& e(v->first_cyclic_core_neighbor());
     const vertex_p w(e->head);
 
+    const uint e_input_id(e->input_id);
     I.g.delete_edge(e);
     // create a copy of v
-    vertex_p vprime(I.g.add_vertex_fast((string)*v + "'"));
-    // and hang it onto w
-    I.g.add_edge_fast(vprime, w);
+    vertex_p vprime(I.g.add_vertex_fast(v->name));
+    // and hang it onto w (the new edge replaces e)
+    I.g.add_edge_fast(vprime, w, e_input_id);
     // then copy v's pendant to vprime
     copy_pendant(I.g, v, vprime);
     // and, finally, gnaw the 2path away
@@ -364,7 +372,7 @@ namespace cr{
     I.k -= deletes;
     // we don't yet know which edges are going to be deleted..
     for(uint i = 0; i < deletes; ++i)
-      sol += "[some edge between " + (string)(*info.generators.front()->head) + " and " + (string)(*info.generators.back()->head) + "]";
+      sol += no_index;
 
     // do the graph modification:
     // 0. save the first and last vertex in order to be able to reconnect
@@ -372,8 +380,8 @@ namespace cr{
     vertex_p last_vertex(last_to_del->head);
     // and save one vertex to be able to delete the component in between
     const vertex_p comp_to_del(first_to_del->head);
-    // (save the name of first_to_del in case we cut a cycle)
-    const string first_to_del_name(*first_to_del);
+    // (save the input edge of first_to_del in case we cut a cycle)
+    const uint first_to_del_id(first_to_del->input_id);
 
     // 1. delete the first and last edge,
     I.g.delete_edge(first_to_del);
@@ -384,7 +392,7 @@ namespace cr{
     edge_p e(find_edge(first_vertex, last_vertex));
     if(e != first_vertex->adj_list.end()){
       // if we broke a cycle, then delete the edge (first_vertex, last_vertex) (destroy the 2-cycle)
-      sol += first_to_del_name;
+      sol += first_to_del_id;
       I.k--;
       // update the TRRs just one edge, and let the parent vertex update the rest
       sol += apply_trrs_upwards_after_cut(I, stat, last_vertex, first_vertex);
@@ -805,7 +813,10 @@ namespace cr{
           list<path_info_t> v_infos;
 
           // run PRR1 on v (might kill v's Y-graph)
-          if(prr1_applicable(v)) perform_prr1(v);
+          if(v->pendant_is_Y() && prr1_applicable(v)) {
+            path_info_t v_path;
+            sol += perform_prr1(I, v, v_path);
+          }
           // run path detection and PRR application from v
           if(!apply_prrs_and_trrs_to_vertex(I, stat, sol, v_infos, v, dfs_id)) {
             // if none of the PRRs apply to v, then try the Y-lookahead rule and go on (Y-lookahead doesn't change paths)
@@ -10,11 +10,11 @@
 namespace cr{
 
   // add a leaf to v, keeping trr_infos up to date; returns edge to the new leaf
-  edge_p& copy_leaf(graph& g, const vertex_p& v, const vertex_p& leaf);
+  edge_p copy_leaf(graph& g, const vertex_p& v, const edge_p& to_leaf);
   // add a P2 to v keeping trr_infos up to date; return edge to the center vertex
-  edge_p& copy_P2(graph& g, const vertex_p& v, const vertex_p& center);
+  edge_p copy_P2(graph& g, const vertex_p& v, const edge_p& to_center);
   // add a Y graph to v keeping trr_infos up to date; return edge to the center vertex
-  edge_p& copy_Y(graph& g, const vertex_p& v, const vertex_p& center);
+  edge_p copy_Y(graph& g, const vertex_p& v, const edge_p& to_center);
 
 
   struct path_info_t{
@@ -48,11 +48,13 @@ namespace cr{
 }
 
 
+namespace cr{
 inline ostream& operator<<(ostream& os, const cr::path_info_t& t){
   if(!t.valid)
     return os << "INVALID ";
   else
     return os << "path: "<< *t.start << ".." << *t.end << " (len " << t.length << ") gen: " << t.generators << " sep: " << t.separators<< " pY: " << t.pendantYs;
 }
+}
 
 #endif
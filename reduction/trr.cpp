@@ -12,9 +12,8 @@ namespace cr{
 
     list<vertex_p> subtree_done;
     // first, set all subtree_NH's to zero and save all leaves, since their (empty) subtrees are done
+    I.g.reset_subtrees();
     for(vertex_p v = I.g.vertices.begin(); v != I.g.vertices.end(); ++v){
-      v->invalidate_parent();
-      v->trr_infos.clear();
       if(v->degree() == 1) // save all leaves
         if(!v->prot) // except if they are protected
           subtree_done.push_back(v);
@@ -78,6 +77,7 @@ namespace cr{
     // always push the newest item to the front
     // otherwise TRR3 might delete a permanent edge after PRR4 cut a de2path
     child->set_parent(e);
+    parent->save_state();
     switch(child->degree()){
       case 1:
         // I'm the only neighbor of my child, so add it as leaf
@@ -110,8 +110,9 @@ namespace cr{
   // if nldeg(v) < 3   and   there is a ptwo, then delete the leaf of the ptwo
   // then, delete all but one leaf
   bool trr14_subtree(instance& I, stats_t& stats, const vertex_p& v){
-    edgelist& leaves(v->trr_infos.leaves);
-    edgelist& ptwos(v->trr_infos.ptwos);
+    v->save_state();
+    pendant_list& leaves(v->trr_infos.leaves);
+    pendant_list& ptwos(v->trr_infos.ptwos);
     bool result = false;
 
     // first, if there is a P_2, then
@@ -120,6 +121,7 @@ namespace cr{
       DEBUG2(cout << "applying TRR4 to " << *v << " L: "<< leaves << " P2: "<<ptwos<< ")" <<endl);
       // delete its leaf - it's the unique leaf in (ptwos.begin())->head's trr_infos :)
       const vertex_p middle(ptwos.front()->head); // middle vertex is unique
+      middle->save_state();
       I.g.delete_vertex(middle->trr_infos.leaves.front()->head);
       middle->trr_infos.leaves.clear();
       // and register the middle vertex as new leaf
@@ -133,14 +135,12 @@ namespace cr{
       DO_STAT(stats.reduct_application[TRR1]++);
       DEBUG2(cout << "TRR1: " << *v << " has " << leaves.size() << " leaves" << endl);
       // delete all leaves but the one with the smallest id
-      edge_pp to_del(leaves.begin());
+      pendant_list::const_iterator to_del(leaves.begin());
       // if we have no P2, then keep a leaf
       if(ptwos.empty()) ++to_del;
-      while(to_del != leaves.end()) {
-        const vertex_p u((*to_del)->head);
-        to_del = leaves.erase(to_del);
-        I.g.delete_vertex(u);
-      }
+      for(; to_del != leaves.end(); ++to_del)
+        I.g.delete_vertex((*to_del)->head);
+      leaves.truncate(ptwos.empty() ? 1 : 0);
       DEBUG2(cout << "cleared all leaves of " << *v);
       DEBUG2(if(ptwos.empty()) cout << " except " << leaves.front(); cout << endl);
       result = true;
@@ -150,8 +150,9 @@ namespace cr{
 
   // while |Y|>0 and ( |Y|+|L|+|P|>1 or there is some permanent edge) delete some y of Y & reduce k by one
   solution_t trr2_subtree(instance& I, stats_t& stat, const vertex_p& v){
+    v->save_state();
     const uint leaves_and_ptwos = v->trr_infos.leaves.size() + v->trr_infos.ptwos.size();
-    edgelist& ygraphs(v->trr_infos.ygraphs);
+    pendant_list& ygraphs(v->trr_infos.ygraphs);
     list<vertex_p> to_del;
     solution_t sol;
 
@@ -181,7 +182,8 @@ namespace cr{
   //  while |P|>2 delete a p in P and decrease k by one; give an edge deletion hint, otherwise, we might
   //  delete the wrong edge after splitting the graph with PRR4
   solution_t trr3_subtree(instance& I, stats_t& stat, const vertex_p& v){
-    edgelist& ptwos(v->trr_infos.ptwos);
+    v->save_state();
+    pendant_list& ptwos(v->trr_infos.ptwos);
     list<vertex_p> to_del;
     solution_t sol;
 
@@ -192,7 +194,7 @@ namespace cr{
       to_del.push_back(ptwos.front()->head);
       I.g.delete_edge(ptwos.front());
       I.k--;
-      sol += (string)*v + "->?";
+      sol += no_index;
       ptwos.pop_front();
     }
     // delete the edges that were cut off
@@ -209,6 +211,7 @@ namespace cr{
     if(!v->trr_infos.tclaws.empty()){
       DO_STAT(stat.reduct_application[TRR5]++);
       DEBUG2(cout << "applying TRR5 to " << *v << "(subtree "<<v->subtree_NH() << ", deg "<< v->degree() << ")" << endl);
+      v->save_state();
       const edge_p& tc(v->trr_infos.tclaws.front());
       const vertex_p w(tc->head);
       solution_t sol;
@@ -251,23 +254,46 @@ namespace cr{
 
  
   // return whether there is a vertex with nldeg>2 or a cycle in the component of v
+  // the DFS uses an explicit stack instead of recursion, since long paths would overflow the call stack
   bool dfs_discover_nldegthree(const size_t dfs_id, const vertex_p& v, const vertex_p& parent){
-    if(v->dfs_id != dfs_id){
-      bool akku = false;
-      v->dfs_id = dfs_id;
-      // be sure to visit the whole connected component, even if a nldeg>2 vertex is found!
-      // Otherwise, later searches in this component might miss this vertex
-      // trr_infos cannot be trusted since a vertex with subtree_NH == degree() may not have some leaves registered
-      if((v->nldeg() > 2) || v->prot){
-        DEBUG2(cout << "found that "<<*v<<" has nldeg "<<v->nldeg()<< " (or enjoys devine protection)"<< endl);
-        akku = true;
+    if(v->dfs_id == dfs_id) return true;// discovered a cycle, which is equally as good
+
+    // the vertices on the DFS path, their parents and the arc that they're currently looking at
+    struct frame_t{
+      vertex_p v, parent;
+      edge_p e;
+    };
+    vector<frame_t> stack;
+    bool akku = false;
+    // be sure to visit the whole connected component, even if a nldeg>2 vertex is found!
+    // Otherwise, later searches in this component might miss this vertex
+    v->dfs_id = dfs_id;
+    stack.push_back(frame_t{v, parent, v->adj_list.begin()});
+    while(!stack.empty()){
+      frame_t& f(stack.back());
+      if(f.e == f.v->adj_list.begin()){
+        // first time we look at f.v
+        // trr_infos cannot be trusted since a vertex with subtree_NH == degree() may not have some leaves registered
+        if((f.v->nldeg() > 2) || f.v->prot){
+          DEBUG2(cout << "found that "<<*f.v<<" has nldeg "<<f.v->nldeg()<< " (or enjoys devine protection)"<< endl);
+          akku = true;
+        }
       }
-      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
-        if(e->head != parent)
-          if(dfs_discover_nldegthree(dfs_id, e->head, v))
-            akku = true;// don't break because the cc must be marked
-      return akku;
-    } else return true;// discovered a cycle, which is equally as good
+      if(f.e == f.v->adj_list.end()) {
+        stack.pop_back();
+        continue;
+      }
+      const edge_p e(f.e++);
+      if(e->head != f.parent){
+        const vertex_p& w(e->head);
+        if(w->dfs_id != dfs_id){
+          w->dfs_id = dfs_id;
+          const vertex_p u(f.v);
+          stack.push_back(frame_t{w, u, w->adj_list.begin()});
+        } else akku = true;// discovered a cycle, which is equally as good (don't break because the cc must be marked)
+      }
+    }
+    return akku;
   }
 
   
@@ -40,26 +40,27 @@ namespace cr{
 
 
   // quick pendant addition, without checks or anything
-  inline void add_nothing(graph& g, const vertex_p& v, const string& name = ""){};
-  inline void add_leaf(graph& g, const vertex_p& v, const string& name = ""){
-    vertex_p w(g.add_vertex_fast((name == "" ? v->name : name) + "~"));
+  // the new vertices get the given name, or the name of v if none is given
+  inline void add_nothing(graph& g, const vertex_p& v, const uint name = no_index){};
+  inline void add_leaf(graph& g, const vertex_p& v, const uint name = no_index){
+    vertex_p w(g.add_vertex_fast(name == no_index ? v->name : name));
     const edge_p e(g.add_edge_fast(w, v));
     // update TRR infos
     update_trr_infos_from_child(e);
   }
-  inline void add_P2(graph& g, const vertex_p& v, const string& name = ""){
-    const vertex_p w(g.add_vertex_fast((name == "" ? v->name : name) + "~"));
+  inline void add_P2(graph& g, const vertex_p& v, const uint name = no_index){
+    const vertex_p w(g.add_vertex_fast(name == no_index ? v->name : name));
     const edge_p e(g.add_edge_fast(w, v));
     add_leaf(g, w, w->name);
     // update TRR infos
     update_trr_infos_from_child(e);
   }
-  inline void add_2P2(graph& g, const vertex_p& v, const string& name = ""){
-    add_P2(g, v, (name == "" ? v->name : name));
-    add_P2(g, v, (name == "" ? v->name : name) + "~~~");
+  inline void add_2P2(graph& g, const vertex_p& v, const uint name = no_index){
+    add_P2(g, v, name);
+    add_P2(g, v, name);
   }
-  inline void add_Y(graph& g, const vertex_p& v, const string& name = ""){
-    const vertex_p w(g.add_vertex_fast((name == "" ? v->name : name) + "~"));
+  inline void add_Y(graph& g, const vertex_p& v, const uint name = no_index){
+    const vertex_p w(g.add_vertex_fast(name == no_index ? v->name : name));
     const edge_p e(g.add_edge_fast(w, v));
     add_2P2(g, w, w->name);
     // update TRR infos
@@ -72,10 +73,8 @@ namespace cr{
 
     g.delete_edge(e);
     add_Y(g, v, u->name);
-    u->name += '\'';
   }
 
-
 }
 
 #endif
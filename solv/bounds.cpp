@@ -2,50 +2,44 @@
 #include "../reduction/trr.hpp"
 #include <unordered_map>
 #include <unordered_set>
+#include <algorithm>
 
 namespace cr{
 
   inline bool edge_p_equal(const edge_p& a, const edge_p& b){
     return (a == b) || (a->get_reversed() == b);
   }
-  bool edge_p_cmp(const edge_p& a, const edge_p& b){
 
-    edge_p e1 = (a->head->id > a->get_reversed()->head->id?a:a->get_reversed());
-    edge_p e2 = (b->head->id > b->get_reversed()->head->id?b:b->get_reversed());
-    
-    const vertex_p& v(e1->get_reversed()->head);
-
-    if(v->id == e2->get_reversed()->head->id){
-      return distance(e1, v->adj_list.end()) > distance(e2, v->adj_list.end());
-    } else return v->id < e2->get_reversed()->head->id;
-    
+  // the root of x in the union-find forest parent, halving the path on the way
+  inline uint find_root(vector<uint>& parent, uint x){
+    while(parent[x] != x) x = parent[x] = parent[parent[x]];
+    return x;
   }
 
-  bool degree_is_less(const vertex& v1, const vertex& v2){
-    return v1.degree() < v2.degree();
-  }
   // compute a lower bound using a packing of 2-stars
-  uint star_packing(graph g){
+  // the stars are not deleted from g, we just remember their edges in removed and skip them from then on
+  uint star_packing(graph& g){
     int k = 0;
-    // first, copy the graph and mark all bridges
-    // second, sort the vertices by their degree
-    g.vertices.sort(degree_is_less);
+    edgeset removed;
+    // first, get the vertices in order of their degree from the degree index
+    vector<vertex_p> by_degree;
+    by_degree.reserve(g.vertices.size());
+    for(uint d = 0; d <= g.max_degree(); ++d)
+      for(uint i = 0; i < g.vertices_of_degree(d); ++i) by_degree.push_back(g.vertex_of_degree(d, i));
     // then check each vertex for being the center of a 2-star
-    for(vertex_p v = g.vertices.begin(); v != g.vertices.end();++v){
+    for(const vertex_p& v : by_degree){
       // save the edges we want to delete, we have to be able to check whether we already marked one for deletion
       edgeset to_delete;
       // mark this vertex and all its neighbors as in the 2-star
       // for each neighbor, try to find another edge
       for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e){
-        // get the first neighbor of e->head
+        if(removed.count(e)) continue;
+        // find an edge at e->head that neither leads to v nor is removed or already in to_delete
         edge_p a(e->head->adj_list.begin());
-        // while a either leads to v or is already in to_delete, advance a
-        do{
+        for(; a != e->head->adj_list.end(); ++a)
           if(a->head != v)
-            if(to_delete.find(a) == to_delete.end())
+            if(!removed.count(a) && (to_delete.find(a) == to_delete.end()))
               break;
-          ++a;
-        } while(a != e->head->adj_list.end());
         // if we found someone with the properties above, then mark the two edges of the branch for deletion
         if(a != e->head->adj_list.end()){
           to_delete.insert(e);
@@ -62,12 +56,22 @@ namespace cr{
         DEBUG2(cout << "found a star with "<<rays<<" rays (now, k = "<<k<<"):" <<endl);
         DEBUG2(for(edgeset::iterator i = to_delete.begin(); i != to_delete.end(); ++i) cout << *i << endl);
 
-        for(edgeset::iterator i = to_delete.begin(); i != to_delete.end(); ++i)
-          g.delete_edge(*i);
+        for(edgeset::iterator i = to_delete.begin(); i != to_delete.end(); ++i){
+          removed.insert(*i);
+          removed.insert((*i)->get_reversed());
+        }
       }
     }
-    // finally, add an FES of the remaining graph
-    k += get_FES(g);
+    // finally, add an FES of the remaining graph: each remaining edge that closes a cycle in a spanning forest
+    vector<uint> parent(g.current_id);
+    for(uint i = 0; i < parent.size(); ++i) parent[i] = i;
+    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v)
+      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+        if((v.index() < e->head.index()) && !removed.count(e)){
+          const uint r(find_root(parent, v.index()));
+          const uint s(find_root(parent, e->head.index()));
+          if(r == s) ++k; else parent[r] = s;
+        }
     return k;
   }
 
@@ -128,8 +132,8 @@ namespace cr{
     // mark bridges, since we'll want to use is_Abridge()
     I.g.mark_bridges();
 
-    // make each vertex nldeg2
-    for(vertex_p v = I.g.vertices.begin(); v != I.g.vertices.end(); ++v)
+    // make each vertex nldeg2 (deleting edges never raises an nldeg, so the vertices of larger nldeg are known up front)
+    for(const vertex_p& v : I.g.high_nldeg_vertices())
       sol += make_nldeg2(I, v);
 
     // if the budget is gone, just return the empty solution
@@ -143,7 +147,7 @@ namespace cr{
     if(I.k <= (int)FES) return solution_t();
 
     for(uint i = 0; i < FES; ++i)
-      sol += "[a non-bridge]";
+      sol += no_index;
     return sol;
   }
 
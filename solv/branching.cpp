@@ -1,6 +1,8 @@
 #include "../util/defs.hpp"
 #include "../util/graphs.hpp"
 #include "../util/b_vector.hpp"
+#include "../util/small_graph.hpp"
+#include "../util/intersect.hpp"
 #include "../reduction/trr.hpp"
 #include "../reduction/prr.hpp"
 #include "../reduction/global.hpp"
@@ -70,40 +72,58 @@ namespace cr{
   }
 
   // get branching ops for BRR1
-  // TODO: this is not optimal! maintain a list of triangles in G instead!
   // TODO: modify for triangles with just one deg-3-vertex!
   bool BRR1(const vertex_p v, branchlist& br){
-    edgelist non_bridges(v->get_cyclic_neighbors());
+    // the triangle index of the graph knows whether there's anything to find here
+    if(!v.get_graph()->triangles_at(v)) return false;
+    // sort the cyclic neighbors of v by index, so we can intersect them with the neighbors of each of them
+    vector<pair<uint, edge_p> > non_bridges;
+    for(const edge_p& e : v->get_cyclic_neighbors()) non_bridges.emplace_back(e->head.index(), e);
+    sort(non_bridges.begin(), non_bridges.end(),
+        [](const pair<uint, edge_p>& x, const pair<uint, edge_p>& y){ return x.first < y.first; });
+    vector<uint> ids(non_bridges.size());
+    for(uint i = 0; i < ids.size(); ++i) ids[i] = non_bridges[i].first;
     DEBUG2(cout << "this is BRR1 for "<<*v<<" with "<<v->adj_list.size()<< " neighbors"<< endl);
-    for(auto i = non_bridges.begin(); i != non_bridges.end(); ++i){
-      const edge_p& a(*i);
-      for(auto j = i; j != non_bridges.end(); ++j){
-        const edge_p& b(*j);
-        if(a != b){
-          edge_p c = find_edge(a->head, b->head);
-          if(c != a->head->adj_list.end()){
-            branch_op bo(Triangle);
-            if(triangle_is_degenerate(v, a->head, b->head)){
-              // register {a,b}-branch
-              if(!a->is_permanent && !b->is_permanent) bo.branches.push_back({graph_mod_t(a), graph_mod_t(b)});
-              // register {c}-branch
-              if(!c->is_permanent) bo.branches.push_back({c});
-            } else {
-              if(!a->is_permanent) bo.branches.push_back({a});
-              if(!b->is_permanent) bo.branches.push_back({b});
-              if(!c->is_permanent) bo.branches.push_back({c});
-            }
-            DEBUG2(cout << "found 3CYC on "<<*a<<", "<<*b<<", "<<*c<<", non-permanent: "<<bo.branches<<endl);
-            if(!bo.branches.empty()){
-              bo.bnum = bo.branches.size();
-              br.push_back(bo);
-              // one BRR1 for each vertex is enuff, it's not getting better branching numbers anyway
-              return true;
-            }
-          } // end if
-        } // end if
-      } // end for
-    } // end for
+    vector<uint> nbrs, common(ids.size());
+    for(uint i = 0; i < ids.size(); ++i){
+      const edge_p& a(non_bridges[i].second);
+      // the triangles {v, a, b} for the cyclic neighbors b after a are the common elements of the rest of ids and the
+      // neighbors of a; if there are only few of them or a has many more neighbors, just look up each b at a
+      const uint* const later(ids.data() + i + 1);
+      const uint num_later(ids.size() - i - 1);
+      uint found(0);
+      if((num_later < intersect_min_length) || (a->head->degree() > intersect_skew * num_later)){
+        for(uint j = 0; j < num_later; ++j)
+          if(adjacent(a->head, vertex_p(v.get_graph(), later[j]))) common[found++] = later[j];
+      } else {
+        nbrs.clear();
+        for(edge_p f = a->head->adj_list.begin(); f != a->head->adj_list.end(); ++f) nbrs.push_back(f->head.index());
+        sort(nbrs.begin(), nbrs.end());
+        found = intersect_sorted(later, num_later, nbrs.data(), nbrs.size(), common.data());
+      }
+      for(uint j = 0; j < found; ++j){
+        const edge_p& b(non_bridges[std::lower_bound(ids.begin() + i + 1, ids.end(), common[j]) - ids.begin()].second);
+        const edge_p c(find_edge(a->head, b->head));
+        branch_op bo(Triangle);
+        if(triangle_is_degenerate(v, a->head, b->head)){
+          // register {a,b}-branch
+          if(!a->is_permanent && !b->is_permanent) bo.branches.push_back({graph_mod_t(a), graph_mod_t(b)});
+          // register {c}-branch
+          if(!c->is_permanent) bo.branches.push_back({c});
+        } else {
+          if(!a->is_permanent) bo.branches.push_back({a});
+          if(!b->is_permanent) bo.branches.push_back({b});
+          if(!c->is_permanent) bo.branches.push_back({c});
+        }
+        DEBUG2(cout << "found 3CYC on "<<*a<<", "<<*b<<", "<<*c<<", non-permanent: "<<bo.branches<<endl);
+        if(!bo.branches.empty()){
+          bo.bnum = bo.branches.size();
+          br.push_back(bo);
+          // one BRR1 for each vertex is enuff, it's not getting better branching numbers anyway
+          return true;
+        }
+      }
+    }
     return false;
   } // end function
 
@@ -267,7 +287,7 @@ namespace cr{
     if(v->is_on_cyclic_core() && (v->nldeg() > 2) ){
       branch_op bop(Token);
       // get the ptwos
-      const edgelist& ptwos(v->trr_infos.ptwos);
+      const pendant_list& ptwos(v->trr_infos.ptwos);
       const unsigned char has_P2(ptwos.empty() ? 0 : 1);
       // assert by reducedness wrt. trr3_gen that |P2|<2
       DEBUG2(assert(ptwos.size() < 2));
@@ -659,8 +679,9 @@ namespace cr{
     branchlist br;
 
     // check BRR6 first, it has the best chance to produce a size-1 branching (and if so, it produces the best size-1 branching)
-    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v)
-      if(BRR6(v, br))
+    // BRR6 only applies to vertices with nldeg at least 3, so just ask the degree index for them
+    for(uint i = 0; i < g.num_high_nldeg(); ++i)
+      if(BRR6(g.high_nldeg_vertex(i), br))
         if(br.back().branches.size() == 1){
           bo = br.back();
           return true; // if we found a reduction, we're happy
@@ -704,14 +725,18 @@ namespace cr{
     }
     */
   
-    // check BRR1
-    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v) if(v->is_on_cycle()){
-      if(BRR1(v, br))
-        if(br.back().branches.size() == 1){
-          bo = br.back();
-          return true; // if we found a reduction, we're happy
-        }
-    } else DEBUG1(cout << "not applying BRR1 to "<<v<<" since "<<v->degree()<<"-"<<v->incident_bridges<<"=0"<<endl);
+    // check BRR1 (if there are any triangles at all)
+    if(g.num_triangles()){
+      for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v){
+        if(v->is_on_cycle()){
+          if(BRR1(v, br))
+            if(br.back().branches.size() == 1){
+              bo = br.back();
+              return true; // if we found a reduction, we're happy
+            }
+        } else DEBUG1(cout << "not applying BRR1 to "<<v<<" since "<<v->degree()<<"-"<<v->incident_bridges()<<"=0"<<endl);
+      }
+    }
     DEBUG2(cout << "done applying BRR1"<<endl);
     // try BRR 2-5
 /*    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v) if(v->is_on_cycle()){
@@ -735,49 +760,49 @@ namespace cr{
 
 
 
-  // apply a Deletion operation
-  inline void apply_Del(instance& I, const edge_p& e, solution_t& sol){
-    I.delete_edge(e, sol);
-  }
-
   // apply a Ygraphify operation
-  void apply_Yify(instance& I, const edge_p& e, solution_t& sol, const string name_add = ""){
+  void apply_Yify(instance& I, const edge_p& e, solution_t& sol){
     const vertex_p v(e->get_tail());
     const vertex_p u(e->head);
-    const string uname(u->name);
-    string name(v->name + name_add);
 
     if(!e->is_permanent){
       // delete the edge
       I.g.delete_edge(e);
       // and add a new Y-graph
-      add_Y(I.g, u, name);
+      add_Y(I.g, u, v->name);
     } else {
       // if the edge we want to delete is permanent, we will delete all but e at the head
       const edge_p e_rev(e->get_reversed());
-      for(edge_p f = u->adj_list.begin(); f != u->adj_list.end();)
-        if(f == e_rev) ++f; else apply_Del(I, f++, sol);
+      edgelist to_delete;
+      for(edge_p f = u->adj_list.begin(); f != u->adj_list.end(); ++f)
+        if(f != e_rev) to_delete.push_back(f);
+      I.delete_edges(to_delete, sol);
     }
     // add a leaf with some name if v is not already recognizable as on backbone
-    if(!v->is_on_backbone()) add_leaf(I.g, v, uname + '*');
+    if(!v->is_on_backbone()) add_leaf(I.g, v, u->name);
   }
 
+  // consecutive deletions are collected and done in one batch
   void apply_one_branch(instance& I, const branch_type& t, const modlist_t& ml, solution_t& sol){
+    edgelist to_delete;
     for(auto gmod : ml){
       switch(gmod.type){
         case Del:
-          apply_Del(I, gmod.e, sol);
+          to_delete.push_back(gmod.e);
           break;
         case Yify:
+          I.delete_edges(to_delete, sol);
+          to_delete.clear();
           apply_Yify(I, gmod.e, sol);
           break;
       }
     }
+    I.delete_edges(to_delete, sol);
   }
 
 
 
-  // process a branching operation: for each of its branches, mke a copy of the graph, apply its changes, and recurse
+  // process a branching operation: for each of its branches, apply its changes to the graph, recurse, and roll them back
   solution_t apply_branch_op(branch_op& bo, instance& I, stats_t& stat, const solv_options& opts, const uint depth){
     solution_t min_sol;
     int known_solution = I.k + 1;
@@ -791,20 +816,21 @@ namespace cr{
       solution_t solprime;
       // save the first edge of ml in case we need to mark it permanent
       graph_mod_t to_be_permanent(ml->front());
-      // make a copy Iprime of I, translating the modlist ml to the new graph
-      unordered_map<uint, vertex_p> id_to_vertex;
-      instance Iprime(I, &id_to_vertex);
-      // convert the mod list for the new graph
-      for(auto &gmod : *ml) gmod.e = convert_edge(gmod.e, id_to_vertex);
+      // instead of copying I, work on I and undo all changes when we're done with the branch
+      I.g.checkpoint();
+      const int k = I.k;
       // we only need to find solutions that are better than what we have
-      Iprime.k = min(I.k, known_solution - 1);
+      I.k = min(I.k, known_solution - 1);
       // delete the edges of this branch
-      apply_one_branch(Iprime, bo.type, *ml, solprime);
+      apply_one_branch(I, bo.type, *ml, solprime);
       // and recurse
-      solprime += run_branching_algo(Iprime, stat, opts, depth+1);
+      solprime += run_branching_algo(I, stat, opts, depth+1);
+      const bool success(I.g.vertices.empty() && !(I.k < 0));
+      I.g.rollback();
+      I.k = k;
 
       // if we were successfull, save the solution
-      if(Iprime.g.vertices.empty() && !(Iprime.k < 0)){
+      if(success){
         DEBUG2(cout << solprime << " is indeed a valid solution and its size is " << solprime.size()<<endl);
         min_sol = solprime;
         // we've found a solution that should be smaller than known_solution
@@ -824,25 +850,68 @@ namespace cr{
   }
 
 
-  // main function solving the problem!
-  // TODO: we copy the graph, this is inefficient! improve!
-  solution_t run_branching_algo(instance& I, stats_t& stat, const solv_options& opts, const uint depth){
-    // keep track of the search tree size
+  // check the deadline only every so many nodes of the small search, since they are much cheaper than a clock read
+  const uint small_search_deadline_period = 256;
+
+  // search the small graph g for solutions with fewer deletions than best, branching on the edges of a smallest
+  // obstruction; dels are the deletions on the way to g and a solution found below replaces best
+  // the edges of earlier branches are kept in later branches, so we mark them permanent
+  // each call counts as a search tree node, so the statistics stay comparable with the normal search
+  // nodes counts the calls, and once the deadline of opts passed, we set out_of_time and unwind
+  void small_search(small_graph& g, vector<small_graph::small_edge>& dels, vector<small_graph::small_edge>& best,
+                    uint& best_size, stats_t& stat, const solv_options& opts, uint& nodes, bool& out_of_time){
     DO_STAT(stat.searchtree_nodes++);
-    DO_STAT(stat.searchtree_depth = max(stat.searchtree_depth, depth));
-    DEBUG5(if(stat.searchtree_nodes % 10000 == 0) cout << "currently at "<< stat.searchtree_nodes<<" nodes"<<endl;);
-    
-    // quick sanity check: if I have less than 7 vertices, then I cannot have a 2-claw, thus the solution is FES
-    if(I.g.vertices.size() < 7) return solv_small_instance(I);
+    if((++nodes % small_search_deadline_period == 0) && opts.out_of_time()) out_of_time = true;
+    if(out_of_time) return;
+    // a single pass of branch and bound: a lower bound that does not beat best lets us give up here
+    if(dels.size() + max(g.fes_size(), g.star_packing()) >= best_size) return;
+    vector<small_graph::small_edge> obstruction;
+    if(!g.get_obstruction(obstruction)) {
+      best = dels;
+      best_size = dels.size();
+      return;
+    }
+    // the edges of an obstruction are distinct, so each edge we mark was not permanent before
+    vector<small_graph::small_edge> marked;
+    for(uint i = 0; (i < obstruction.size()) && !out_of_time; ++i){
+      const uint u(obstruction[i].first), v(obstruction[i].second);
+      if(g.is_permanent(u, v)) continue;
+      g.delete_edge(u, v);
+      dels.push_back(obstruction[i]);
+      small_search(g, dels, best, best_size, stat, opts, nodes, out_of_time);
+      dels.pop_back();
+      g.add_edge(u, v);
+      g.mark_permanent(u, v);
+      marked.push_back(obstruction[i]);
+    }
+    for(uint i = 0; i < marked.size(); ++i) g.mark_permanent(marked[i].first, marked[i].second, false);
+  }
 
-    solution_t sol;
-    // [1.] apply preprocessing
-    DEBUG4(cout << "=== Phase 1 (depth "<<depth<<"): TRRs ===== (k = "<<I.k<<")"<<endl);
-    sol += apply_trrs(I, stat);
-    DEBUG2(I.g.write_to_stream(std::cout));
-    DEBUG4(cout << "=== Phase 2 (depth "<<depth<<"): PRRs ("<< sol.size() <<" dels, k = "<<I.k<<") ====="<<endl);
-    // first, apply the split rule
-    apply_split_rule(I);
+  // solve an instance of at most 64 vertices on the bitset engine
+  // if there is no solution with at most I.k deletions (or none at all, for example because all edges of an
+  // obstruction are permanent), we fail; if the deadline of opts passes, we fail like run_branching_algo() does
+  solution_t solv_small_component(instance& I, stats_t& stat, const solv_options& opts){
+    small_graph sg(I.g);
+    vector<small_graph::small_edge> dels, best;
+    // we only look for solutions of size at most I.k, and no solution deletes more than all edges
+    uint best_size(min(I.k, (int)sg.num_edges()) + 1);
+    const uint no_solution(best_size);
+    uint nodes = 0;
+    bool out_of_time = false;
+    small_search(sg, dels, best, best_size, stat, opts, nodes, out_of_time);
+    if(out_of_time || (best_size == no_solution)) {I.k = -1; return solution_t();}
+
+    edgelist el;
+    for(uint i = 0; i < best.size(); ++i) el.push_back(find_edge(sg.vertex_of[best[i].first], sg.vertex_of[best[i].second]));
+    solution_t sol(edgelist_to_solution(el));
+    I.k -= sol.size();
+    I.g.clear();
+    return sol;
+  }
+
+  // the part of a search-tree node after the TRRs and the split rule: PRRs, bounds, components, global rules and
+  // branching; sol holds the deletions done by the first part
+  solution_t branching_node(instance& I, stats_t& stat, const solv_options& opts, const uint depth, solution_t sol){
     // the PRRs can give us a list of deg-2 paths which we use for BRR78
     list<path_info_t> deg2paths;
     sol += apply_prrs(I, opts, stat, deg2paths);
@@ -855,8 +924,9 @@ namespace cr{
     // we do another check later, but here, we can avoid computing the lower bound
     if(I.k <= 0) return solution_t();
 
-    // quick sanity check: if I am reduced with respect to the PRRs and TRR and I have less than 8 vertices, then any FES is a solution
-    if(I.g.vertices.size() < 8) { sol += solv_small_instance(I); return sol; }
+    // quick sanity check: if I has less than 7 vertices, then it cannot have a 2-claw, so any FES is a solution
+    // (a 2-claw has 7 vertices, and even reduced graphs on 7 vertices may have an FES whose deletion leaves one)
+    if(I.g.vertices.size() < 7) { sol += solv_small_instance(I); return sol; }
 
     DEBUG2(cout << "got "<<deg2paths.size()<<" deg2paths:"<<endl; for(auto i = deg2paths.begin(); i != deg2paths.end(); ++i) cout << *i << endl;);
     // [2.] get a lower bound
@@ -930,6 +1000,13 @@ namespace cr{
     //}
 
 
+    // we split off all other components above, so I.g is a connected component, and if it is small, then we solve it on
+    // the bitset engine
+    if(I.g.vertices.size() <= min(opts.bitset_max_vertices, bitset_max_useful_vertices)){
+      sol += solv_small_component(I, stat, opts);
+      return sol;
+    }
+
     // [4.] start branching
     DEBUG4(cout << "=== Phase 5 (depth "<<depth<<"): branchings ("<< sol.size() <<" dels) ====="<<endl);
     DEBUG3(I.g.write_to_stream(std::cout));
@@ -986,6 +1063,48 @@ namespace cr{
     }
   }
 
+  // main function solving the problem!
+  solution_t run_branching_algo(instance& I, stats_t& stat, const solv_options& opts, const uint depth){
+    // keep track of the search tree size
+    DO_STAT(stat.searchtree_nodes++);
+    DO_STAT(stat.searchtree_depth = max(stat.searchtree_depth, depth));
+    DEBUG5(if(stat.searchtree_nodes % 10000 == 0) cout << "currently at "<< stat.searchtree_nodes<<" nodes"<<endl;);
+    // if we ran out of time, fail (see solv_options::deadline)
+    if(opts.out_of_time()){
+      I.k = -1;
+      return solution_t();
+    }
+
+    // quick sanity check: if I have less than 7 vertices, then I cannot have a 2-claw, thus the solution is FES
+    if(I.g.vertices.size() < 7) return solv_small_instance(I);
+
+    solution_t sol;
+    // [1.] apply preprocessing
+    DEBUG4(cout << "=== Phase 1 (depth "<<depth<<"): TRRs ===== (k = "<<I.k<<")"<<endl);
+    sol += apply_trrs(I, stat);
+    DEBUG2(I.g.write_to_stream(std::cout));
+    DEBUG4(cout << "=== Phase 2 (depth "<<depth<<"): PRRs ("<< sol.size() <<" dels, k = "<<I.k<<") ====="<<endl);
+    // first, apply the split rule
+    apply_split_rule(I);
+
+    // move the survivors into fresh storage in an order that keeps neighbors close together, and continue there (the
+    // moved vertices are just marked deleted in I.g); we do this at the root and, if most of the storage of the graph
+    // is dead by now, further down to renumber_max_depth
+    if(((int)depth <= opts.renumber_max_depth) && (I.g.vertices.size() < I.g.current_id)
+       && ((depth == 0) || (2 * I.g.vertices.size() < I.g.current_id))){
+      instance Inew;
+      I.g.move_all(Inew.g);
+      Inew.k = I.k;
+      // the pendant infos (trr_infos) stay behind in I.g, so rebuild them for Inew before anything can read them
+      const solution_t rec_sol(branching_node(Inew, stat, opts, depth, update_TRR_infos(Inew, stat)));
+      if(!Inew.g.vertices.empty() || (Inew.k < 0)) {I.k = -1; return solution_t();}
+      I.k = Inew.k;
+      sol += rec_sol;
+      return sol;
+    }
+    return branching_node(I, stat, opts, depth, sol);
+  }
+
 
 
 
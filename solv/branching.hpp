@@ -23,11 +23,14 @@ namespace cr{
   // run the complete branching recursively and return the number of operation it took
   solution_t run_branching_algo(instance& I, stats_t& stats, const solv_options& opts = default_opts, uint depth = 0);
 
+  // solve an instance of at most 64 vertices on the bitset engine (see small_graph), I.k < 0 on failure
+  solution_t solv_small_component(instance& I, stats_t& stat, const solv_options& opts);
+
   // solve a small instance (|V|<7) to save some branching
   inline solution_t solv_small_instance(instance& I){
     solution_t fes(edgelist_to_solution(get_a_FES(I.g)));
     I.k -= fes.size();
-    I.g.vertices.clear();
+    I.g.clear();
     return fes;
   }
 
@@ -36,6 +39,7 @@ namespace cr{
 }
 
 
+namespace cr{
 inline ostream& operator<<(ostream& os, const cr::branch_op& bop){
   return os << "[" << bop.type << ": "<< bop.branches << "] ("<<bop.bnum<<")";
 }
@@ -43,5 +47,6 @@ inline ostream& operator<<(ostream& os, const cr::branch_op& bop){
 inline ostream& operator<<(ostream& os, const cr::claw_leg& cl){
   return os << "{ "<< cl.head << ", "<<cl.E<<" }";
 }
+}
 
 #endif
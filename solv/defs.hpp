@@ -34,6 +34,7 @@ namespace cr{
   typedef list<branch_op> branchlist;
 }
 
+namespace cr{
 inline ostream& operator<<(ostream& os, const cr::branch_type& t){
   switch(t){
     case cr::Triangle: os <<"Triangle"; break;
@@ -59,6 +60,6 @@ inline ostream& operator<<(ostream& os, const cr::mod_type& t){
 inline ostream& operator<<(ostream& os, const cr::graph_mod_t& m){
   return os << m.type << ' ' << m.e;
 }
-
+}
 
 #endif
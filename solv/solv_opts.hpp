@@ -1,6 +1,8 @@
 #ifndef SOLV_OPTS_HPP
 #define SOLV_OPTS_HPP
 
+#include <chrono>
+
 namespace cr {
   struct solv_options{
     uint fast_lower_bound_layers_wait;
@@ -9,7 +11,21 @@ namespace cr {
     bool elaborate_branch_selection;
     float keep_searching_if_bnum_above;
     uint max_size_for_Y_lookahead;
+    int renumber_max_depth;
+    uint bitset_max_vertices;
+    // once the clock passes this point, every search-tree node fails right away, so the search returns quickly with a
+    // useless result; whoever sets a deadline has to check whether it passed before trusting the solution
+    std::chrono::steady_clock::time_point deadline;
+
+    // has the deadline passed?
+    inline bool out_of_time() const {
+      return (deadline != std::chrono::steady_clock::time_point::max()) && (std::chrono::steady_clock::now() > deadline);
+    }
   };
+  // the bitset engine has no reduction rules, so on larger components its search trees outgrow those of the normal
+  // search (r1 takes about 8% longer with 20 and 60% longer with 28), and bitset_max_vertices is capped to this
+  const uint bitset_max_useful_vertices = 16;
+
   const solv_options default_opts = {
     1, // fast_lower_bound_layers_wait
     8, // slow_lower_bound_layers_wait
@@ -17,14 +33,19 @@ namespace cr {
     false, // elaborate branch selection
     2.5, // keep searching for branching applications if bnum is above this number
     30, // maximum size of G to allow performing Y_lookahead
+    -1, // move the graph into fresh, locality-friendly storage at search-tree nodes up to this depth (-1 = never)
+    16, // solve connected components with at most this many vertices on the bitset engine (at most the limit below)
+    std::chrono::steady_clock::time_point::max(), // never give up
   };
 
 };
 
 
+namespace cr{
 inline ostream& operator<<(ostream& os, const cr::solv_options& opts){
   return os << " 1. slow lower bound computation each " << opts.slow_lower_bound_layers_wait << " layers"<<endl;
 }
+}
 
 #endif
 
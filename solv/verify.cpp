@@ -2,60 +2,43 @@
 #include "../reduction/trr.hpp"
 #include "../util/statistics.hpp"
 #include "../solv/branching.hpp"
-#include <map>
-#include <string>
-#include <algorithm>
 
 namespace cr{
 
-  vector<string> &split(const std::string &s, char delim, std::vector<std::string> &elems) {
-      std::stringstream ss(s);
-      std::string item;
-      while (std::getline(ss, item, delim)) {
-          elems.push_back(item);
-      }
-      return elems;
-  }
-
-
-  bool verify_solution(instance I, solution_t sol){
-    map<string, vertex_p> name_to_vertex;
+  bool verify_solution_in_place(instance& I, solution_t sol, const chrono::steady_clock::time_point deadline){
     DEBUG3(uint sol_size = sol.size());
     DEBUG2(cout << "======== final phase: verification of "<<sol<<endl);
     // start with applying TRR6 to get rid of caterpillars
     
-    // first, get the ID to vertex map
+    // first, find the edges of I representing the input edges
+    vector<edge_p> input_edge(I.g.input->edges.size());
     for(vertex_p v = I.g.vertices.begin(); v != I.g.vertices.end(); ++v)
-      name_to_vertex.insert(make_pair(v->name, v));
+      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+        if(e->input_id != no_index) input_edge[e->input_id] = e;
 
+    edgelist to_delete;
     for(solution_t::iterator s = sol.begin(); s != sol.end();){
-      uint delim_pos = s->find("->");
-      if(delim_pos != s->npos){
-        // parse the two vertex IDs
-        string name1 = s->substr(0, delim_pos);
-        string name2 = s->substr(delim_pos+2);
-        // remove primes
-        name1.erase(remove(name1.begin(), name1.end(), '\''), name1.end());
-        name2.erase(remove(name2.begin(), name2.end(), '\''), name2.end());
-        // delete edge
-        if(name_to_vertex.find(name1) != name_to_vertex.end() && name_to_vertex.find(name2) != name_to_vertex.end()){
-          edge_p to_delete = find_edge(name_to_vertex[name1], name_to_vertex[name2]);
-          if(to_delete != name_to_vertex[name1]->adj_list.end()){
-            I.g.delete_edge(to_delete);
-            // remove from solution
-            sol.erase(s++);
-            // remove caterpillars from the remaining instance, this way, we also notice non-optimality
-          } else {DEBUG2(cout << "couldn't find "<<*s<<" in the graph"<<endl); ++s;}
-        } else {DEBUG2(cout << *s << " is a special edge, I cannot delete it"<<endl); ++s;}
-      } else {DEBUG2(cout << *s << " is a special edge, I cannot delete it"<<endl); ++s;}
+      if(*s != no_index){
+        edge_p& e(input_edge[*s]);
+        if(e.index() != no_index){
+          to_delete.push_back(e);
+          e = edge_p();
+          // remove from solution
+          sol.erase(s++);
+          // remove caterpillars from the remaining instance, this way, we also notice non-optimality
+        } else {DEBUG2(cout << *s << " has already been deleted"<<endl); ++s;}
+      } else {DEBUG2(cout << "some edge is a special edge, I cannot delete it"<<endl); ++s;}
     }
+    I.g.delete_edges(to_delete);
     DEBUG3(cout << " successfully deleted "<< sol_size - sol.size()<< " edges, "<< sol.size() << " to go"<<endl);
     trr6(I);
 
     I.k = sol.size();
     // use the branching algorithm to solve the remaining graph
     stats_t stats;
-    solution_t new_sol(run_branching_algo(I, stats));
+    solv_options opts(default_opts);
+    opts.deadline = deadline;
+    solution_t new_sol(run_branching_algo(I, stats, opts));
     // if I got solved within the budget, then the solution is verified, otherwise, it's not
     if( (new_sol.size() == sol.size()) && I.g.vertices.empty()){
       DEBUG4(cout << "verified " << sol << " by " << new_sol<<endl);
@@ -67,4 +50,13 @@ namespace cr{
     }
   }
 
+
+  bool verify_solution(const instance& I, solution_t sol, const chrono::steady_clock::time_point deadline){
+    // the input infos are shared by all graphs derived from the input, so they still describe the input graph
+    instance Iinput;
+    Iinput.g.input = I.g.input;
+    Iinput.g.rebuild_input();
+    return verify_solution_in_place(Iinput, sol, deadline);
+  }
+
 }
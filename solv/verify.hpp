@@ -1,7 +1,11 @@
 #include "../util/graphs.hpp"
+#include "solv_opts.hpp"
 
 namespace cr{
 
-  // verify a solution
-  bool verify_solution(instance I, solution_t sol);
+  // verify a solution for the input graph that I was derived from
+  // I itself is not looked at (the solver may have changed it), the input graph is rebuilt from its input infos
+  // the verification solves what remains after deleting sol, which fails once the deadline passed
+  bool verify_solution(const instance& I, solution_t sol,
+                       const chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max());
 };
@@ -27,19 +27,23 @@ namespace cr{
   }
 
 
+  // a backbone vertex has two cyclic core neighbors and a pendant, or at least three cyclic core neighbors,
+  // so its degree is at least 3 and we let the degree index give us the candidates
   vertex_p find_backbone_vertex(graph& g){
-    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v){
-      switch(v->cyc_core_degree()){
-        case 0:
-        case 1: continue;
-        case 2: 
-          if(has_favorable_pendant(v)) return v;
-          break;
-        default:
-          if(has_favorable_pendant(v)) return v;
-          if(has_long_deg2_path(v)) return v;
+    for(uint d = g.max_degree(); d > 2; --d)
+      for(uint i = 0; i < g.vertices_of_degree(d); ++i){
+        const vertex_p v(g.vertex_of_degree(d, i));
+        switch(v->cyc_core_degree()){
+          case 0:
+          case 1: continue;
+          case 2: 
+            if(has_favorable_pendant(v)) return v;
+            break;
+          default:
+            if(has_favorable_pendant(v)) return v;
+            if(has_long_deg2_path(v)) return v;
+        }
       }
-    }
     return g.vertices.end();
   }
 
@@ -55,7 +59,8 @@ namespace cr{
       vertex_p u(e->get_tail());
 
       // if v has any Y-graph pendants, delete the connecting edge
-      edgelist& ygraphs(v->trr_infos.ygraphs);
+      v->save_state();
+      pendant_list& ygraphs(v->trr_infos.ygraphs);
       while(!ygraphs.empty()){
         I.delete_edge(ygraphs.front(), sol);
         ygraphs.pop_front();
@@ -79,6 +84,7 @@ namespace cr{
     vertex_p v(e->head);
     vertex_p u(e->get_tail());
     // protect v
+    v->save_state();
     v->prot = true;
     // 1. apply TRRs
     sol += update_TRR_infos(I, stats);
@@ -98,20 +104,24 @@ namespace cr{
 
     solution_t best_sol;
     for(edge_p c : choices){
-      // copy instance
-      unordered_map<uint, vertex_p> id_to_vertex;
-      instance Iprime(I, &id_to_vertex);
+      // work on I directly and roll back the changes afterwards
+      I.g.checkpoint();
+      const int k = I.k;
       solution_t solprime;
       // Y-graphify 
       for(edge_p f : choices) if(f->head != c->head)
-        Ygraphify(Iprime.g, find_edge(id_to_vertex[f->get_tail()->id], id_to_vertex[f->head->id]));
+        Ygraphify(I.g, f);
 
-      edge_p cprime(find_edge(id_to_vertex[c->get_tail()->id], id_to_vertex[c->head->id]));
+      edge_p cprime(c);
+      bool success;
       // if we can successfully grow to the next deg3 vertex, then call grow_cat_from again
-      if(grow_to_deg3(cprime, id_to_vertex[do_not_cross->id], Iprime, stats, opts, solprime)){
-        if(!grow_cat_from(cprime, id_to_vertex[do_not_cross->id], Iprime, stats, opts, solprime)) continue;
-      } else // otherwise, call run_worm_trace
-        if(!run_worm_trace(Iprime, solprime, stats, opts)) continue;
+      if(grow_to_deg3(cprime, do_not_cross, I, stats, opts, solprime))
+        success = grow_cat_from(cprime, do_not_cross, I, stats, opts, solprime);
+      else // otherwise, call run_worm_trace
+        success = run_worm_trace(I, solprime, stats, opts);
+      I.g.rollback();
+      I.k = k;
+      if(!success) continue;
 
       // if we arrive here, we've found a solution in solprime
       best_sol = solprime;
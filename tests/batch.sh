@@ -0,0 +1,25 @@
+#!/bin/sh
+# solve a directory with good and malformed files in batch mode: every file gets its line, in the order of the names,
+# and a malformed file does not keep the files after it from being solved
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+printf 'a b\nb c\nc a\n' > "$dir/1_triangle"
+printf 'p td 3 2\n1 2\np td 1 0\n' > "$dir/2_two_problem_lines.gr"
+printf 'p td 3 99999999999999999\n1 2\n1 4\n' > "$dir/3_vertex_out_of_range.gr"
+printf '\001\002' > "$dir/4_garbage"
+printf 'p td 4 3\n1 2\n2 3\n3 4\n' > "$dir/5_path.gr"
+
+expected="1_triangle	1
+2_two_problem_lines.gr	unreadable
+3_vertex_out_of_range.gr	unreadable
+4_garbage	0
+5_path.gr	0"
+for jobs in 1 3; do
+  got=$(../cr batch "$dir" -BJ $jobs | cut -f1,2 | sed "s|^$dir/||")
+  if [ "$got" != "$expected" ]; then
+    echo "batch with $jobs workers failed, got:"
+    echo "$got"
+    exit 1
+  fi
+done
+echo "batch: 5 files with 1 and 3 workers, 0 failures"
@@ -0,0 +1,134 @@
+// write graphs in the binary format and read them back, and make sure truncated and corrupt files are reported
+#include "../util/graph_io.hpp"
+#include <cstring>
+#include <random>
+
+using namespace std;
+using namespace cr;
+
+// the arcs of g as (tail name, head name, index, permanent), in the order of the vertices and their adjacency lists
+vector<string> arcs_of(const graph& g){
+  vector<string> arcs;
+  for(vertex_pc v = g.vertices.begin(); v != g.vertices.end(); ++v)
+    for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+      arcs.push_back((string)*v + " " + (string)*e->head + " " + to_string(e.index()) + (e->is_permanent ? " p" : ""));
+  return arcs;
+}
+
+string to_binary(const graph& g){
+  ostringstream out;
+  write_binary(g, out);
+  return out.str();
+}
+
+// does reading the buffer fail with an input_error?
+bool rejects(const string& buffer){
+  graph g;
+  try{
+    read_binary(g, buffer.data(), buffer.data() + buffer.size());
+  } catch(const input_error&) {return true;}
+  return false;
+}
+
+// a file as the writer would lay it out, without names and flags
+string make_binary(const vector<uint32_t>& offsets, const vector<uint32_t>& targets, const vector<uint32_t>& ranks){
+  const uint32_t head[3] = {binary_version, 0, (uint32_t)offsets.size() - 1};
+  const uint64_t sizes[2] = {targets.size() / 2, 0};
+  string buffer("CRGB");
+  buffer.append((const char*)head, 12);
+  buffer.append((const char*)sizes, 16);
+  buffer.append((const char*)offsets.data(), 4 * offsets.size());
+  buffer.append((const char*)targets.data(), 4 * targets.size());
+  buffer.append((const char*)ranks.data(), 4 * ranks.size());
+  return buffer;
+}
+
+uint failures = 0;
+
+void expect(const bool ok, const string& what){
+  if(!ok){
+    cout << "binary: " << what << endl;
+    ++failures;
+  }
+}
+
+// write g, read it back and compare, then make sure that every truncation of the file is rejected
+void check_round_trip(const graph& g, const string& name){
+  const string buffer(to_binary(g));
+  graph h;
+  read_binary(h, buffer.data(), buffer.data() + buffer.size());
+  expect(h.vertices.size() == g.vertices.size(), name + ": the vertices changed");
+  expect(h.edgenum == g.edgenum, name + ": the number of edges changed");
+  expect(arcs_of(h) == arcs_of(g), name + ": the arcs changed");
+  expect(to_binary(h) == buffer, name + ": writing the graph again gives a different file");
+  // the name data is last, so losing any byte loses something
+  for(size_t len = 0; len < buffer.size(); ++len)
+    if(!rejects(buffer.substr(0, len))){
+      expect(false, name + ": a file truncated to " + to_string(len) + " bytes was accepted");
+      break;
+    }
+}
+
+int main(){
+  std::mt19937 rng(1);
+
+  // a graph with names and permanent edges
+  const string text("a b\nb c\nc a\nc d\nd e\ne f\nf d\nlong_vertex_name a\n");
+  graph g;
+  read_edge_list(g, text.data(), text.data() + text.size());
+  uint i = 0;
+  for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v)
+    for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+      if(((i++) % 3 == 0) && !e->is_permanent) e->mark_permanent();
+  check_round_trip(g, "named graph");
+
+  // a numbered graph without permanent edges and with isolated vertices
+  const string pace("p td 7 4\n1 2\n2 3\n3 1\n5 7\n");
+  graph numbered;
+  read_pace(numbered, pace.data(), pace.data() + pace.size());
+  check_round_trip(numbered, "numbered graph");
+
+  // random graphs
+  for(uint round = 0; round < 50; ++round){
+    ostringstream edges;
+    const uint n(2 + rng() % 40), m(rng() % (3 * n));
+    for(uint j = 0; j < m; ++j) edges << 'v' << rng() % n << " v" << rng() % n << '\n';
+    const string s(edges.str());
+    graph r;
+    read_edge_list(r, s.data(), s.data() + s.size());
+    check_round_trip(r, "random graph " + to_string(round));
+  }
+
+  // the hand-made version of the path 0-1-2 is fine...
+  expect(!rejects(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 3})), "the path 0-1-2 was rejected");
+  // ... but these are not
+  expect(rejects(make_binary({0, 2, 4}, {1, 1, 0, 0}, {0, 2, 1, 3})), "a parallel edge was accepted");
+  expect(rejects(make_binary({0, 1, 3, 4}, {1, 0, 3, 1}, {0, 1, 2, 3})), "an arc to a missing vertex was accepted");
+  expect(rejects(make_binary({0, 1, 3, 4}, {1, 0, 1, 1}, {0, 1, 2, 3})), "a loop was accepted");
+  expect(rejects(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 2})), "a repeated rank was accepted");
+  expect(rejects(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 4})), "a rank out of range was accepted");
+  expect(rejects(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 2, 1, 3})), "arcs that are no reversals were accepted");
+  expect(rejects(make_binary({0, 3, 1, 4}, {1, 0, 2, 1}, {0, 1, 2, 3})), "decreasing offsets were accepted");
+  expect(rejects(make_binary({1, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 3})), "offsets not starting at 0 were accepted");
+  string wrong_version(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 3}));
+  wrong_version[4] = 99;
+  expect(rejects(wrong_version), "an unknown version was accepted");
+  expect(rejects("CRGB"), "a bare magic number was accepted");
+  // an edge count whose double overflows to the 4 arcs that are there
+  string overflow(make_binary({0, 1, 3, 4}, {1, 0, 2, 1}, {0, 1, 2, 3}));
+  const uint64_t huge_m(((uint64_t)1 << 63) + 2);
+  overflow.replace(16, 8, (const char*)&huge_m, 8);
+  expect(rejects(overflow), "an edge count that overflows was accepted");
+
+  // flipping random bytes must either be caught or still give a graph (never crash or read outside of the buffer)
+  const string valid(to_binary(g));
+  uint caught = 0;
+  for(uint round = 0; round < 2000; ++round){
+    string corrupt(valid);
+    for(uint flips = 1 + rng() % 3; flips; --flips) corrupt[rng() % corrupt.size()] ^= 1 << (rng() % 8);
+    caught += rejects(corrupt);
+  }
+
+  cout << "binary: 52 round trips, 2000 corruptions (" << caught << " caught), " << failures << " failures" << endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+// parse the same edge lists with different numbers of threads and make sure the graphs come out exactly the same
+#include "../util/graph_io.hpp"
+#include <map>
+#include <random>
+
+using namespace std;
+using namespace cr;
+
+// the names of the vertices in order and, for each of them, its arcs in order (head and index)
+string describe(const graph& g){
+  ostringstream s;
+  for(vertex_pc v = g.vertices.begin(); v != g.vertices.end(); ++v){
+    s << v->id << '=' << (string)*v << ':';
+    for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e) s << ' ' << e->head->id << '/' << e.index();
+    s << '\n';
+  }
+  return s.str();
+}
+
+string read(const string& text, const uint threads){
+  graph g;
+  read_edge_list(g, text.data(), text.data() + text.size(), threads);
+  return describe(g);
+}
+
+// the graph as the header of read_edge_list() describes it: the names are numbered in order of first appearance and
+// the edges are added one by one, leaving out loops and repeated edges
+string reference(const string& text){
+  istringstream in(text);
+  vector<string> tokens;
+  for(string token; in >> token;) tokens.push_back(token);
+  graph g;
+  map<string, vertex_p> vertex_of;
+  for(size_t i = 0; i + 1 < tokens.size(); i += 2){
+    vertex_p ends[2];
+    for(uint j = 0; j < 2; ++j){
+      const map<string, vertex_p>::const_iterator it(vertex_of.find(tokens[i + j]));
+      ends[j] = (it != vertex_of.end()) ? it->second : (vertex_of[tokens[i + j]] = g.add_vertex_fast(tokens[i + j]));
+    }
+    if(ends[0] != ends[1]) g.add_edge_secure(ends[0], ends[1]);
+  }
+  return describe(g);
+}
+
+// a random edge list on up to n names, some of them longer than the 8 bytes that are hashed at once, with repeated
+// edges, loops, empty lines, odd whitespace and lines of more than two names
+string random_edge_list(std::mt19937& rng, const uint n, const uint lines){
+  const char* const space[] = {" ", "\t", "  ", " \r", "\v"};
+  ostringstream s;
+  for(uint i = 0; i < lines; ++i){
+    const uint tokens((rng() % 8 == 0) ? rng() % 5 : 2);
+    for(uint j = 0; j < tokens; ++j){
+      if(j) s << space[rng() % 5];
+      const uint name(rng() % n);
+      s << ((name % 3 == 0) ? "a_rather_long_vertex_name_" : "v") << name;
+    }
+    s << ((rng() % 4 == 0) ? "\r\n" : "\n");
+  }
+  return s.str();
+}
+
+int main(){
+  std::mt19937 rng(1);
+  uint failures = 0, runs = 0;
+  vector<string> inputs = {
+    "", "a", "a b", "a b\n", "a b c", "a b\nb c\nc", "\n\n a \n b \n", "x x\nx y\ny x\n",
+    // a single long line, so all cuts but the last move to its end
+    "a b c d e f g h i j k l m n o p q r s t u v w x y z a c b d",
+  };
+  for(uint round = 0; round < 200; ++round)
+    inputs.push_back(random_edge_list(rng, 1 + rng() % (round + 2), rng() % (5 * round + 10)));
+  // odd numbers of names in total, so that the last name has no partner
+  for(uint round = 0; round < 20; ++round){
+    const string input(random_edge_list(rng, 50, 100 + rng() % 100));
+    istringstream in(input);
+    uint names = 0;
+    for(string name; in >> name;) ++names;
+    inputs.push_back((names % 2) ? input : input + "lonely_name");
+  }
+
+  for(const string& input : inputs){
+    const string expected(read(input, 1));
+    if(expected != reference(input)){
+      cout << "edge list: one thread read a different graph than adding the edges one by one from:" << endl << input << endl;
+      ++failures;
+    }
+    for(const uint threads : {2u, 3u, 7u}){
+      // the cuts land at the (t/threads)-th byte and move to the start of the next line from there
+      if(read(input, threads) != expected){
+        cout << "edge list: " << threads << " threads read a different graph from:" << endl << input << endl;
+        ++failures;
+      }
+      ++runs;
+    }
+  }
+  cout << "edge list: " << runs << " runs, " << failures << " failures" << endl;
+  return failures ? 1 : 0;
+}
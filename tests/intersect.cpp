@@ -0,0 +1,66 @@
+// check the vector versions of intersect_sorted() against the plain merge on random sorted arrays
+#include "../util/intersect.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace std;
+using namespace cr;
+
+typedef uint (*intersect_fn)(const uint*, const uint, const uint*, const uint, uint*);
+
+// a sorted array of n distinct numbers below range
+vector<uint> random_sorted(std::mt19937& rng, const uint n, const uint range){
+  std::set<uint> s;
+  while(s.size() < n) s.insert(rng() % range);
+  return vector<uint>(s.begin(), s.end());
+}
+
+// compare f against intersect_scalar on a and b (both ways round), return the number of mismatches
+uint check(const char* name, intersect_fn f, const vector<uint>& a, const vector<uint>& b){
+  uint failures = 0;
+  for(uint swap = 0; swap < 2; ++swap){
+    const vector<uint>& x(swap ? b : a);
+    const vector<uint>& y(swap ? a : b);
+    vector<uint> expected(min(x.size(), y.size()) + 1), got(min(x.size(), y.size()) + 1);
+    expected.resize(intersect_scalar(x.data(), x.size(), y.data(), y.size(), expected.data()));
+    got.resize(f(x.data(), x.size(), y.data(), y.size(), got.data()));
+    if(got != expected){
+      cout << name << " failed on lists of length " << x.size() << " and " << y.size()
+           << ": got " << got.size() << " common elements instead of " << expected.size() << endl;
+      ++failures;
+    }
+  }
+  return failures;
+}
+
+int main(){
+  __builtin_cpu_init();
+  const bool avx2(__builtin_cpu_supports("avx2"));
+  const bool avx512(__builtin_cpu_supports("avx512f"));
+  std::mt19937 rng(1);
+  uint failures = 0, runs = 0;
+  // lengths that are not multiples of the vector width leave tails for the scalar merge, small ranges give many
+  // common elements and large ranges give few
+  for(uint na = 0; na <= 70; ++na)
+    for(uint nb = 0; nb <= 70; nb += 1 + (na % 3))
+      for(const uint range : {na + nb + 1, 2 * (na + nb) + 1, 100000u}){
+        const vector<uint> a(random_sorted(rng, na, max(range, na)));
+        const vector<uint> b(random_sorted(rng, nb, max(range, nb)));
+        if(avx2) failures += check("AVX2", intersect_avx2, a, b);
+        if(avx512) failures += check("AVX-512", intersect_avx512, a, b);
+        failures += check("intersect_sorted", intersect_sorted, a, b);
+        ++runs;
+      }
+  // long lists of very different lengths, so one side is exhausted long before the other
+  for(uint i = 0; i < 200; ++i){
+    const vector<uint> a(random_sorted(rng, 1 + rng() % 1000, 5000));
+    const vector<uint> b(random_sorted(rng, 1 + rng() % 50, 5000));
+    if(avx2) failures += check("AVX2", intersect_avx2, a, b);
+    if(avx512) failures += check("AVX-512", intersect_avx512, a, b);
+    ++runs;
+  }
+  cout << "intersect: " << runs << " runs (AVX2 " << (avx2 ? "on" : "off") << ", AVX-512 " << (avx512 ? "on" : "off")
+       << "), " << failures << " failures" << endl;
+  return failures ? 1 : 0;
+}
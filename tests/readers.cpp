@@ -0,0 +1,114 @@
+// read the same graphs from all text formats, check the format detection, and make sure malformed files are reported
+#include "../util/graph_io.hpp"
+#include <algorithm>
+
+using namespace std;
+using namespace cr;
+
+uint failures = 0, checks = 0;
+
+void expect(const bool ok, const string& what){
+  ++checks;
+  if(!ok){
+    cout << "readers: " << what << endl;
+    ++failures;
+  }
+}
+
+// the number of vertices and the sorted edges of g, by the names of their ends
+string describe(const graph& g){
+  vector<string> edges;
+  for(vertex_pc v = g.vertices.begin(); v != g.vertices.end(); ++v)
+    for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+      if((string)*v < (string)*e->head) edges.push_back((string)*v + "-" + (string)*e->head);
+  sort(edges.begin(), edges.end());
+  string s(to_string(g.vertices.size()) + ":");
+  for(const string& e : edges) s += " " + e;
+  return s;
+}
+
+// read text with read_graph() and describe the result ("error" if it threw an input_error)
+string read(const string& text, const uint threads = 0){
+  graph g;
+  try{
+    read_graph(g, text.data(), text.data() + text.size(), threads);
+  } catch(const input_error&) {return "error";}
+  return describe(g);
+}
+
+graph_format detect(const string& text) {return detect_format(text.data(), text.data() + text.size());}
+
+int main(){
+  // the triangle 1,2,3 and the edge 4-5 in all formats
+  const string triangle("5: 1-2 1-3 2-3 4-5");
+  const string pace("c a comment\np tw 5 4\n1 2\n2 3\n\nc another comment\n3 1\n4 5\n");
+  const string dimacs("c a comment\np edge 5 4\ne 1 2\nn 1 7\ne 2 3\ne 3 1\ne 4 5\n");
+  const string metis("% a comment\n5 4\n2 3\n1 3\n% another comment\n1 2\n5\n4\n");
+  const string metis_weights("5 4 011 2\n7 8 2 1 3 1\n7 8 1 1 3 1\n7 8 1 1 2 1\n7 8 5 9\n7 8 4 9\n");
+  const string metis_sizes("5 4 100\n1 2 3\n1 1 3\n1 1 2\n1 5\n1 4\n");
+  const string edges("1 2\n2 3\n3 1\n4 5\n");
+
+  expect(detect(pace) == format_pace, "PACE was not detected");
+  expect(detect(dimacs) == format_dimacs, "DIMACS was not detected");
+  expect(detect("p col 5 4\ne 1 2\n") == format_dimacs, "DIMACS with \"p col\" was not detected");
+  expect(detect(metis) == format_metis, "METIS was not detected");
+  expect(detect(metis_weights) == format_metis, "METIS with weights was not detected");
+  expect(detect("a b\nb c\n") == format_edge_list, "an edge list was not detected");
+  expect(detect("1 2 3 4 5\n") == format_edge_list, "a line of 5 numbers was taken for a METIS header");
+  expect(detect("p 1 2\n") == format_edge_list, "a short problem line was taken for a problem line");
+  graph binary;
+  read_edge_list(binary, edges.data(), edges.data() + edges.size());
+  ostringstream out;
+  write_binary(binary, out);
+  expect(detect(out.str()) == format_binary, "the binary format was not detected");
+  expect(read(out.str()) == triangle, "the binary format was read as " + read(out.str()));
+
+  expect(read(pace) == triangle, "PACE was read as " + read(pace));
+  expect(read(dimacs) == triangle, "DIMACS was read as " + read(dimacs));
+  expect(read(metis) == triangle, "METIS was read as " + read(metis));
+  expect(read(metis_weights) == triangle, "METIS with weights was read as " + read(metis_weights));
+  expect(read(metis_sizes) == triangle, "METIS with vertex sizes was read as " + read(metis_sizes));
+  // the first line looks like a METIS header, but the rest does not match, so this is an edge list after all
+  expect(detect(edges) == format_metis, "the edge list did not look like METIS");
+  expect(read(edges) == triangle, "the edge list was read as " + read(edges));
+  // so is a METIS file with too many edges in the header (and without reserving memory for them)
+  const string metis_oversized("3 99999999999\n2\n1\n\n");
+  expect(read(metis_oversized) == "4: 1-2 3-99999999999", "METIS with an oversized header was read as " + read(metis_oversized));
+  // and one with a neighbor that does not exist
+  expect(read("3 1\n2\n1\n4\n") == "3: 1-2 1-3", "METIS with a missing vertex was read as " + read("3 1\n2\n1\n4\n"));
+  expect(read("3 1 2\n2\n1\n\n") == "3: 1-3", "METIS with a bad fmt was read as " + read("3 1 2\n2\n1\n\n"));
+
+  // loops and repeated edges are dropped, and isolated vertices are kept
+  expect(read("p td 4 4\n1 2\n2 1\n1 1\n1 2\n") == "4: 1-2", "PACE with repeated edges was read as " + read("p td 4 4\n1 2\n2 1\n1 1\n1 2\n"));
+  // an edge count that no file of this size could hold does not make us reserve memory for it
+  expect(read("p td 3 99999999999999999\n1 2\n") == "3: 1-2", "PACE with an oversized header failed");
+  expect(read("p edge 3 99999999999999999\ne 1 2\n") == "3: 1-2", "DIMACS with an oversized header failed");
+
+  // malformed files
+  expect(read("p td 3 2\n1 2\np td 1 0\n") == "error", "a second problem line was accepted");
+  expect(read("p edge 3 2\ne 1 2\np edge 1 0\n") == "error", "a second DIMACS problem line was accepted");
+  expect(read("p td 3 1\n1 4\n") == "error", "a vertex above n was accepted");
+  expect(read("p td 3 1\n0 1\n") == "error", "vertex 0 was accepted");
+  expect(read("p edge 3 1\ne 1\n") == "error", "an edge with one end was accepted");
+  expect(read("p td 4294967295 1\n1 2\n") == "error", "too many vertices were accepted");
+  const string no_problem_line("1 2\n");
+  graph g;
+  bool threw = false;
+  try{
+    read_pace(g, no_problem_line.data(), no_problem_line.data() + no_problem_line.size());
+  } catch(const input_error&) {threw = true;}
+  expect(threw, "PACE without a problem line was accepted");
+  threw = false;
+  const string edge_first("1 2\np td 2 1\n");
+  try{
+    read_pace(g, edge_first.data(), edge_first.data() + edge_first.size());
+  } catch(const input_error&) {threw = true;}
+  expect(threw, "an edge before the problem line was accepted");
+
+  // the numbered readers split their work the same way for any number of threads
+  for(const uint threads : {1u, 2u, 5u})
+    expect(read(pace, threads) == triangle, "PACE with " + to_string(threads) + " threads was read as " + read(pace, threads));
+
+  cout << "readers: " << checks << " checks, " << failures << " failures" << endl;
+  return failures ? 1 : 0;
+}
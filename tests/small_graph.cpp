@@ -0,0 +1,141 @@
+// solve random graphs of up to 16 vertices on the bitset engine and compare to brute force, and make sure the search
+// finds the same solutions with and without the bitset engine
+#include "../util/graphs.hpp"
+#include "../util/small_graph.hpp"
+#include "../solv/branching.hpp"
+#include <algorithm>
+#include <random>
+
+using namespace std;
+using namespace cr;
+
+struct test_graph {
+  uint n;
+  vector<pair<uint, uint> > edges;
+  vector<bool> permanent;
+};
+
+// is the graph on the vertices 0 to n-1 with the given edges (those that are not deleted) a caterpillar forest?
+// it is iff it has no cycle and no vertex has more than two neighbors that are not leaves
+bool is_caterpillar_forest(const test_graph& t, const vector<bool>& deleted){
+  vector<uint> root(t.n), degree(t.n, 0);
+  for(uint u = 0; u < t.n; ++u) root[u] = u;
+  auto find = [&](uint u){ while(root[u] != u) u = root[u] = root[root[u]]; return u; };
+  for(uint i = 0; i < t.edges.size(); ++i) if(!deleted[i]){
+    const uint ru(find(t.edges[i].first)), rw(find(t.edges[i].second));
+    if(ru == rw) return false;
+    root[ru] = rw;
+    ++degree[t.edges[i].first];
+    ++degree[t.edges[i].second];
+  }
+  vector<uint> inner_neighbors(t.n, 0);
+  for(uint i = 0; i < t.edges.size(); ++i) if(!deleted[i]){
+    if(degree[t.edges[i].second] > 1) ++inner_neighbors[t.edges[i].first];
+    if(degree[t.edges[i].first] > 1) ++inner_neighbors[t.edges[i].second];
+  }
+  for(uint u = 0; u < t.n; ++u) if(inner_neighbors[u] > 2) return false;
+  return true;
+}
+
+// try all ways to delete k more edges from the i-th on
+bool delete_some(const test_graph& t, vector<bool>& deleted, const uint i, const uint k){
+  if(k == 0) return is_caterpillar_forest(t, deleted);
+  for(uint j = i; j < t.edges.size(); ++j) if(!t.permanent[j] && !deleted[j]){
+    deleted[j] = true;
+    const bool found(delete_some(t, deleted, j + 1, k - 1));
+    deleted[j] = false;
+    if(found) return true;
+  }
+  return false;
+}
+
+// the number of edges to delete besides the deleted ones in a smallest solution, or -1 if there is none
+int brute_force(const test_graph& t, vector<bool> deleted){
+  for(uint k = 0; k <= t.edges.size(); ++k) if(delete_some(t, deleted, 0, k)) return k;
+  return -1;
+}
+
+// a connected graph: a random tree with some more edges, some of which are permanent
+test_graph random_graph(std::mt19937& rng, const uint n, const uint extra, const uint permanent_percent){
+  test_graph t;
+  t.n = n;
+  vector<vector<bool> > adjacent(n, vector<bool>(n, false));
+  auto add = [&](const uint u, const uint w){
+    if((u == w) || adjacent[u][w]) return;
+    adjacent[u][w] = adjacent[w][u] = true;
+    t.edges.push_back(make_pair(u, w));
+    t.permanent.push_back(rng() % 100 < permanent_percent);
+  };
+  for(uint u = 1; u < n; ++u) add(rng() % u, u);
+  for(uint i = 0; i < extra; ++i) add(rng() % n, rng() % n);
+  return t;
+}
+
+void make_instance(const test_graph& t, instance& I){
+  vector<vertex_p> vertex(t.n);
+  for(uint u = 0; u < t.n; ++u) vertex[u] = I.g.add_vertex_fast(to_string(u));
+  vector<edge_p> edge;
+  for(uint i = 0; i < t.edges.size(); ++i) edge.push_back(I.g.add_edge_fast(vertex[t.edges[i].first], vertex[t.edges[i].second]));
+  I.g.set_as_input();
+  for(uint i = 0; i < t.edges.size(); ++i) if(t.permanent[i]) edge[i]->mark_permanent();
+  I.k = t.edges.size();
+}
+
+// solve t with solver and return the size of the solution (-1 if there is none), or -2 if the solution is wrong
+template<class Solver>
+int solve(const test_graph& t, const Solver& solver){
+  instance I;
+  make_instance(t, I);
+  const shared_ptr<input_info_t> input(I.g.input);
+  const solution_t sol(solver(I));
+  if(I.k < 0) return -1;
+  if(!I.g.vertices.empty()) return -2;
+  // translate the input edges of the solution back to the edges of t (vertex u of t got the name with index u)
+  vector<vector<uint> > index(t.n, vector<uint>(t.n, no_index));
+  for(uint i = 0; i < t.edges.size(); ++i) index[t.edges[i].first][t.edges[i].second] = index[t.edges[i].second][t.edges[i].first] = i;
+  // some rules of the search register "some edge" (no_index) instead of an edge, which brute force has to find
+  vector<bool> deleted(t.edges.size(), false);
+  int some_edges = 0;
+  for(const uint e : sol){
+    if(e == no_index) {++some_edges; continue;}
+    if(e >= input->edges.size()) return -2;
+    const uint i(index[input->edges[e].first][input->edges[e].second]);
+    if(deleted[i] || t.permanent[i]) return -2;
+    deleted[i] = true;
+  }
+  return (brute_force(t, deleted) == some_edges) ? (int)sol.size() : -2;
+}
+
+int main(){
+  std::mt19937 rng(1);
+  uint failures = 0, runs = 0;
+  solv_options bitset_opts(default_opts), search_opts(default_opts);
+  search_opts.bitset_max_vertices = 0;
+  for(uint round = 0; round < 3000; ++round){
+    const uint n(2 + rng() % 15);
+    // at most about 22 edges, so that brute force stays quick
+    const test_graph t(random_graph(rng, n, rng() % min(n + 2, 24 - n), (round % 3) * 15));
+    const int expected(brute_force(t, vector<bool>(t.edges.size(), false)));
+    const int bitset(solve(t, [&](instance& I){ stats_t stats; return solv_small_component(I, stats, bitset_opts); }));
+    int with_bitsets(0), without_bitsets(0);
+    // the search expects the permanent edges to come from its own rules (for example, it takes any FES of a graph with
+    // less than 7 vertices), so we only give it graphs without
+    if(find(t.permanent.begin(), t.permanent.end(), true) == t.permanent.end()){
+      with_bitsets = solve(t, [&](instance& I){ stats_t stats; return run_branching_algo(I, stats, bitset_opts); });
+      without_bitsets = solve(t, [&](instance& I){ stats_t stats; return run_branching_algo(I, stats, search_opts); });
+    }
+    // the reduction rules of the search do not always find an optimal solution (on 14 vertices with edges 0-1 0-2 0-3
+    // 0-4 4-5 3-6 3-7 0-8 0-9 1-10 6-11 7-12 5-13 12-9 5-7 9-2, they delete 4 edges instead of 3), so we only insist
+    // that its solutions are correct and that the bitset engine does not change them
+    if((bitset != expected) || (with_bitsets < 0) || (without_bitsets < 0) || (with_bitsets != without_bitsets)){
+      cout << "small graph: on " << n << " vertices with edges";
+      for(uint i = 0; i < t.edges.size(); ++i) cout << ' ' << t.edges[i].first << '-' << t.edges[i].second << (t.permanent[i] ? "!" : "");
+      cout << " brute force found " << expected << ", solv_small_component " << bitset << ", the search with bitsets "
+           << with_bitsets << " and without " << without_bitsets << " (-1 = no solution, -2 = wrong solution)" << endl;
+      ++failures;
+    }
+    ++runs;
+  }
+  cout << "small graph: " << runs << " runs, " << failures << " failures" << endl;
+  return failures ? 1 : 0;
+}
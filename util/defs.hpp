@@ -67,6 +67,16 @@
 typedef unsigned int uint;
 
 
+// declare the generic output operators up front so they can find each other
+template<class T, class Q> std::ostream& operator<<(std::ostream& os, const std::unordered_set<T, Q>& l);
+template<class T, class Q, class R> std::ostream& operator<<(std::ostream& os, const std::unordered_map<T, Q, R>& l);
+template<class T> std::ostream& operator<<(std::ostream& os, const std::unordered_multiset<T>& l);
+template<class T> std::ostream& operator<<(std::ostream& os, const std::list<T>& l);
+template<class T, class Q> std::ostream& operator<<(std::ostream& os, const std::pair<T, Q>& l);
+template<class T> std::ostream& operator<<(std::ostream& os, const std::vector<T>& l);
+// make the generic output operators visible from inside namespace cr, whose own operator<< would hide them otherwise
+namespace cr { using ::operator<<; }
+
 // generec merge of lists
 template<class T>
 std::list<T>& operator+=(std::list<T>& l1, const std::list<T>& l2){
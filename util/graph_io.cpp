@@ -0,0 +1,617 @@
+#include "graph_io.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cr {
+
+// report malformed input to the caller of the reader (see input_error)
+#define INPUT_FAIL(x) {ostringstream msg; msg << x; throw input_error(msg.str());}
+
+  mapped_file::mapped_file(const char* filename):data(NULL),length(0){
+    const int fd(open(filename, O_RDONLY));
+    if(fd < 0) return;
+    struct stat st;
+    if((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)){
+      void* const p(mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+      if(p != MAP_FAILED){
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        data = (const char*)p;
+        length = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  mapped_file::~mapped_file(){
+    if(data) munmap((void*)data, length);
+  }
+
+  // the characters that "istream >> string" skips
+  inline bool is_space(const char c){
+    return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+  }
+
+  // hash a name 8 bytes at a time
+  inline uint64_t hash_name(const char* s, const uint len){
+    uint64_t h(len);
+    uint i = 0;
+    for(; i + 8 <= len; i += 8){
+      uint64_t chunk;
+      memcpy(&chunk, s + i, 8);
+      h = mix64(h ^ chunk);
+    }
+    if(i < len){
+      uint64_t chunk = 0;
+      memcpy(&chunk, s + i, len - i);
+      h = mix64(h ^ chunk);
+    }
+    return h;
+  }
+
+  // the number of threads to use for work of the given size, if the caller left it to us (threads == 0)
+  // below a few MB of input, starting threads costs more than it saves
+  static uint thread_count(const size_t work, const size_t min_work_per_thread, const uint threads){
+    if(threads) return threads;
+    const uint cores(max(thread::hardware_concurrency(), 1u));
+    return (uint)min((size_t)cores, 1 + work / min_work_per_thread);
+  }
+
+  // run f(0) to f(threads-1) in parallel, f(0) on the calling thread
+  template<class Function>
+  static void parallel_for(const uint threads, const Function& f){
+    vector<thread> workers;
+    workers.reserve(threads - 1);
+    for(uint t = 1; t < threads; ++t) workers.push_back(thread(f, t));
+    f(0);
+    for(thread& w : workers) w.join();
+  }
+
+  // the part [ (t * size) / parts, ((t+1) * size) / parts ) of size things
+  inline size_t part_begin(const size_t size, const uint t, const uint parts) {return (size * t) / parts;}
+
+  // number the distinct names pointing into the input, in order of first appearance
+  // this is an open-addressing table holding the numbers, which is kept at most half full
+  class name_table {
+    vector<uint> slots;
+    uint64_t mask;
+  public:
+    // the names, by number
+    vector<pair<const char*, uint> > names;
+
+    explicit name_table(const size_t expected):slots(),mask(0),names(){
+      size_t capacity = 16;
+      while(capacity < 2 * expected) capacity *= 2;
+      slots.assign(capacity, no_index);
+      mask = capacity - 1;
+      names.reserve(expected);
+    }
+
+    inline uint insert(const char* s, const uint len) {return insert(s, len, hash_name(s, len));}
+    // insert a name whose hash_name() we already know
+    uint insert(const char* s, const uint len, const uint64_t hash){
+      for(uint64_t i = hash & mask; ; i = (i + 1) & mask){
+        const uint n(slots[i]);
+        if(n == no_index){
+          slots[i] = names.size();
+          names.push_back(make_pair(s, len));
+          if(2 * names.size() > slots.size()) grow();
+          return names.size() - 1;
+        }
+        if((names[n].second == len) && !memcmp(names[n].first, s, len)) return n;
+      }
+    }
+
+  private:
+    void grow(){
+      slots.assign(2 * slots.size(), no_index);
+      mask = slots.size() - 1;
+      for(uint n = 0; n < names.size(); ++n){
+        uint64_t i(hash_name(names[n].first, names[n].second) & mask);
+        while(slots[i] != no_index) i = (i + 1) & mask;
+        slots[i] = n;
+      }
+    }
+  };
+
+  // build g from a list of edges between the vertices 0 to n-1, which are added in the order of the list
+  // we keep the first occurrence of each edge that is not a loop; if names is NULL, the vertices are numbered instead
+  static void build_graph(graph& g, const uint n, const vector<pair<uint, uint> >& ends,
+                          const vector<pair<const char*, uint> >* const names, uint threads = 0){
+    // to find repeated edges, we bucket the edges by their smaller end with a counting sort, whose buckets are in
+    // the order of the input, so the first edge in each bucket going to the same larger end is the one to keep
+    // each thread counts and scatters a slice of the edges into the ranges of smaller ends, then sorts one range
+    const size_t m(ends.size());
+    threads = min(thread_count(m, 1 << 20, threads), max(n, 1u));
+    auto range_of = [&](const uint u) -> uint {return ((uint64_t)u * threads) / n;};
+    vector<uint> range_begin(threads + 1);
+    for(uint r = 0; r <= threads; ++r) range_begin[r] = ((uint64_t)r * n + threads - 1) / threads;
+
+    vector<vector<size_t> > count(threads, vector<size_t>(threads + 1, 0));
+    parallel_for(threads, [&](const uint t){
+      for(size_t i = part_begin(m, t, threads); i < part_begin(m, t + 1, threads); ++i)
+        if(ends[i].first != ends[i].second) ++count[t][range_of(min(ends[i].first, ends[i].second))];
+    });
+    // turn the counts into the position of slice t in range r, ranges in order, slices in order within each range
+    vector<size_t> range_at(threads + 1, 0);
+    size_t at = 0;
+    for(uint r = 0; r < threads; ++r){
+      range_at[r] = at;
+      for(uint t = 0; t < threads; ++t){
+        const size_t c(count[t][r]);
+        count[t][r] = at;
+        at += c;
+      }
+      range_at[r + 1] = at;
+    }
+    vector<uint> by_range(range_at[threads]), bucketed(range_at[threads]);
+    vector<char> keep(m, false);
+    parallel_for(threads, [&](const uint t){
+      for(size_t i = part_begin(m, t, threads); i < part_begin(m, t + 1, threads); ++i)
+        if(ends[i].first != ends[i].second) by_range[count[t][range_of(min(ends[i].first, ends[i].second))]++] = i;
+    });
+    parallel_for(threads, [&](const uint r){
+      const uint lo(range_begin[r]);
+      vector<size_t> bucket_at(range_begin[r + 1] - lo + 1, range_at[r]);
+      for(size_t j = range_at[r]; j < range_at[r + 1]; ++j)
+        ++bucket_at[min(ends[by_range[j]].first, ends[by_range[j]].second) - lo + 1];
+      for(uint u = 1; u < bucket_at.size(); ++u) bucket_at[u] += bucket_at[u - 1] - range_at[r];
+      vector<size_t> next(bucket_at);
+      for(size_t j = range_at[r]; j < range_at[r + 1]; ++j)
+        bucketed[next[min(ends[by_range[j]].first, ends[by_range[j]].second) - lo]++] = by_range[j];
+      // in each bucket, sort the edges by their larger end (and then by their position) and keep the first of each run
+      auto larger = [&](const uint i) -> uint {return max(ends[i].first, ends[i].second);};
+      for(uint u = 0; u + 1 < bucket_at.size(); ++u){
+        const vector<uint>::iterator first(bucketed.begin() + bucket_at[u]), last(bucketed.begin() + bucket_at[u + 1]);
+        if(last - first > 1)
+          sort(first, last, [&](const uint i, const uint j){return make_pair(larger(i), i) < make_pair(larger(j), j);});
+        for(vector<uint>::iterator i = first; i != last; ++i)
+          if((i == first) || (larger(*i) != larger(*(i - 1)))) keep[*i] = true;
+      }
+    });
+    vector<uint>().swap(by_range);
+    vector<uint>().swap(bucketed);
+    // put the kept edges into CSR form, edge j gets the arcs 2j (in the list of its first end) and 2j+1, so each
+    // adjacency list has the order of the input, as if the edges were added one by one
+    vector<uint> offsets(n + 1, 0);
+    uint edges = 0;
+    for(size_t i = 0; i < m; ++i)
+      if(keep[i]){
+        ++offsets[ends[i].first + 1];
+        ++offsets[ends[i].second + 1];
+        ++edges;
+      }
+    for(uint u = 0; u < n; ++u) offsets[u + 1] += offsets[u];
+    vector<uint> next(offsets.begin(), offsets.end() - 1), targets(2 * (size_t)edges), ranks(2 * (size_t)edges);
+    uint arc = 0;
+    for(size_t i = 0; i < m; ++i)
+      if(keep[i]){
+        const uint u(ends[i].first), w(ends[i].second);
+        targets[next[u]] = w;
+        ranks[next[u]++] = arc++;
+        targets[next[w]] = u;
+        ranks[next[w]++] = arc++;
+      }
+    vector<uint>().swap(next);
+    vector<char>().swap(keep);
+
+    // finally, build the graph
+    g.build_csr(n, offsets.data(), targets.data(), ranks.data());
+    g.input = make_shared<input_info_t>();
+    g.input->numbered = (names == NULL);
+    if(names){
+      g.input->names.reserve(n);
+      for(const pair<const char*, uint>& name : *names) g.input->names.emplace_back(name.first, name.second);
+    }
+    g.set_as_input();
+  }
+
+  // a name in the input and its hash_name()
+  struct name_ref {
+    const char* s;
+    uint len;
+    uint64_t hash;
+  };
+
+  // the names get the same numbers for any number of threads:
+  //  1. each thread tokenizes a chunk of the input (cut at line boundaries), hashing the names as it goes and listing
+  //     the names of each shard (by hash) separately
+  //  2. each thread numbers the names of its shard in order of appearance, going through the lists of the chunks
+  //  3. the first appearances of the names are ranked over all shards (with a prefix sum over the chunks)
+  //  4. each thread translates the names of its chunk into these ranks
+  // (even for a single thread, hashing all names before looking them up beats doing both in one pass)
+  void read_edge_list(graph& g, const char* const begin, const char* const end, uint threads){
+    threads = thread_count(end - begin, 1 << 22, threads);
+    vector<const char*> cut(threads + 1, begin);
+    cut[threads] = end;
+    for(uint t = 1; t < threads; ++t){
+      const char* p(max(cut[t - 1], begin + part_begin(end - begin, t, threads)));
+      while((p != end) && (p != begin) && (p[-1] != '\n')) ++p;
+      cut[t] = p;
+    }
+    auto shard_of = [&](const uint64_t hash) -> uint {return ((hash >> 32) * threads) >> 32;};
+    // the tokens of each chunk and, for each shard, the indices of the tokens in the chunk that belong to it
+    vector<vector<name_ref> > tokens(threads);
+    vector<vector<vector<size_t> > > by_shard(threads, vector<vector<size_t> >(threads));
+    parallel_for(threads, [&](const uint c){
+      tokens[c].reserve((cut[c + 1] - cut[c]) / 8);
+      for(const char* p = cut[c]; p != cut[c + 1];){
+        while((p != cut[c + 1]) && is_space(*p)) ++p;
+        if(p == cut[c + 1]) break;
+        const char* const name(p);
+        while((p != cut[c + 1]) && !is_space(*p)) ++p;
+        const name_ref ref = {name, (uint)(p - name), hash_name(name, p - name)};
+        by_shard[c][shard_of(ref.hash)].push_back(tokens[c].size());
+        tokens[c].push_back(ref);
+      }
+    });
+    // the position of the first token of each chunk; a final name without a partner is dropped
+    vector<size_t> chunk_at(threads + 1, 0);
+    for(uint c = 0; c < threads; ++c) chunk_at[c + 1] = chunk_at[c] + tokens[c].size();
+    const size_t used(chunk_at[threads] & ~(size_t)1);
+
+    // number each shard in order of appearance (its tokens in chunk order); for each token, remember the number of its
+    // name in its shard
+    vector<uint> number(used);
+    vector<char> is_first(used, false);
+    vector<vector<uint> > first_at(threads);
+    vector<name_table> tables(threads, name_table(used / (2 * threads) + 1));
+    parallel_for(threads, [&](const uint t){
+      for(uint c = 0; c < threads; ++c){
+        for(const size_t j : by_shard[c][t]){
+          const size_t pos(chunk_at[c] + j);
+          if(pos >= used) break;
+          const name_ref& ref(tokens[c][j]);
+          number[pos] = tables[t].insert(ref.s, ref.len, ref.hash);
+          if(number[pos] == first_at[t].size()){
+            first_at[t].push_back(pos);
+            is_first[pos] = true;
+          }
+        }
+        vector<size_t>().swap(by_shard[c][t]);
+      }
+    });
+    // rank the first appearances: count them in each chunk, then number them from the start of the chunk
+    vector<uint> firsts_before(threads + 1, 0);
+    parallel_for(threads, [&](const uint c){
+      for(size_t pos = chunk_at[c]; pos < min(chunk_at[c + 1], used); ++pos) firsts_before[c + 1] += is_first[pos];
+    });
+    for(uint c = 0; c < threads; ++c) firsts_before[c + 1] += firsts_before[c];
+    const uint n(firsts_before[threads]);
+    parallel_for(threads, [&](const uint c){
+      uint next(firsts_before[c]);
+      for(size_t pos = chunk_at[c]; pos < min(chunk_at[c + 1], used); ++pos) if(is_first[pos]) number[pos] = next++;
+    });
+    // translate the numbers in each shard to the ranks, and put the names in order
+    vector<pair<const char*, uint> > names(n);
+    vector<vector<uint> > rank(threads);
+    parallel_for(threads, [&](const uint t){
+      rank[t].reserve(first_at[t].size());
+      for(uint i = 0; i < first_at[t].size(); ++i){
+        rank[t].push_back(number[first_at[t][i]]);
+        names[rank[t].back()] = tables[t].names[i];
+      }
+    });
+    vector<pair<uint, uint> > ends(used / 2);
+    parallel_for(threads, [&](const uint c){
+      for(size_t j = 0, pos = chunk_at[c]; (j < tokens[c].size()) && (pos < used); ++j, ++pos){
+        const uint v(is_first[pos] ? number[pos] : rank[shard_of(tokens[c][j].hash)][number[pos]]);
+        if(pos & 1) ends[pos / 2].second = v; else ends[pos / 2].first = v;
+      }
+    });
+    vector<vector<name_ref> >().swap(tokens);
+    vector<uint>().swap(number);
+    vector<name_table>().swap(tables);
+
+    build_graph(g, n, ends, &names, threads);
+  }
+
+  // the characters separating the tokens of a line
+  inline bool is_blank(const char c){
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+  }
+  inline bool is_digit(const char c) {return (c >= '0') && (c <= '9');}
+
+  inline void skip_blanks(const char*& p, const char* const end){
+    while((p != end) && is_blank(*p)) ++p;
+  }
+  // move p to the start of the next line
+  inline void skip_line(const char*& p, const char* const end){
+    while((p != end) && (*p != '\n')) ++p;
+    if(p != end) ++p;
+  }
+  inline bool at_line_end(const char* const p, const char* const end) {return (p == end) || (*p == '\n');}
+
+  // read the number at p (if there is one) and skip the blanks behind it
+  inline bool parse_number(const char*& p, const char* const end, uint64_t& x){
+    if((p == end) || !is_digit(*p)) return false;
+    x = 0;
+    while((p != end) && is_digit(*p)) x = 10 * x + (*p++ - '0');
+    skip_blanks(p, end);
+    return true;
+  }
+
+  // read a vertex given by its number 1 to n and return its index 0 to n-1, or no_index if there is none such
+  inline uint parse_vertex(const char*& p, const char* const end, const uint n){
+    uint64_t x;
+    return (parse_number(p, end, x) && (x >= 1) && (x <= n)) ? x - 1 : no_index;
+  }
+
+  graph_format detect_format(const char* const begin, const char* const end){
+    if(is_binary_graph(begin, end)) return format_binary;
+    for(const char* p = begin; p != end; skip_line(p, end)){
+      skip_blanks(p, end);
+      if(at_line_end(p, end) || (*p == '%')) continue;
+      // a comment is a line whose first token is "c"
+      if((*p == 'c') && ((p + 1 == end) || is_space(p[1]))) continue;
+      // the problem line "p <type> <vertices> <edges>" of the DIMACS family
+      if((*p == 'p') && (p + 1 != end) && is_blank(p[1])){
+        ++p;
+        skip_blanks(p, end);
+        const char* const type(p);
+        while((p != end) && !is_space(*p)) ++p;
+        const string t(type, p);
+        skip_blanks(p, end);
+        uint64_t n, m;
+        if(!parse_number(p, end, n) || !parse_number(p, end, m) || !at_line_end(p, end)) return format_edge_list;
+        return ((t == "edge") || (t == "col")) ? format_dimacs : format_pace;
+      }
+      // the METIS header: 2 to 4 numbers
+      uint numbers = 0;
+      uint64_t x;
+      while(parse_number(p, end, x)) ++numbers;
+      return (at_line_end(p, end) && (numbers >= 2) && (numbers <= 4)) ? format_metis : format_edge_list;
+    }
+    return format_edge_list;
+  }
+
+  // PACE and DIMACS only differ in that DIMACS edge lines start with "e"
+  static void read_problem_format(graph& g, const char* const begin, const char* const end, const bool dimacs, const uint threads){
+    uint n(no_index);
+    vector<pair<uint, uint> > ends;
+    for(const char* p = begin; p != end; skip_line(p, end)){
+      skip_blanks(p, end);
+      if(at_line_end(p, end) || (*p == 'c')) continue;
+      if(*p == 'p'){
+        const char* const line(p);
+        if(n != no_index) INPUT_FAIL("second problem line at byte "<<(line - begin));
+        ++p;
+        skip_blanks(p, end);
+        while((p != end) && !is_space(*p)) ++p;
+        skip_blanks(p, end);
+        uint64_t num_vertices, num_edges;
+        if(!parse_number(p, end, num_vertices) || !parse_number(p, end, num_edges) || (num_vertices >= no_index))
+          INPUT_FAIL("malformed problem line at byte "<<(line - begin));
+        n = num_vertices;
+        // do not trust the header with the memory: each edge line takes at least 4 bytes
+        ends.reserve(min<uint64_t>(num_edges, (end - begin) / 4));
+        continue;
+      }
+      if(dimacs){
+        // skip all other kinds of lines ("n" for vertex weights, ...)
+        if((*p != 'e') || (p + 1 == end) || !is_blank(p[1])) continue;
+        ++p;
+        skip_blanks(p, end);
+      }
+      const char* const line(p);
+      if(n == no_index) INPUT_FAIL("edge before the problem line at byte "<<(line - begin));
+      const uint u(parse_vertex(p, end, n));
+      const uint w(parse_vertex(p, end, n));
+      if((u == no_index) || (w == no_index)) INPUT_FAIL("expected two vertices between 1 and "<<n<<" at byte "<<(line - begin));
+      ends.push_back(make_pair(u, w));
+    }
+    if(n == no_index) INPUT_FAIL("no problem line (\"p <type> <vertices> <edges>\") found");
+    build_graph(g, n, ends, NULL, threads);
+  }
+
+  void read_pace(graph& g, const char* const begin, const char* const end, const uint threads){
+    read_problem_format(g, begin, end, false, threads);
+  }
+
+  void read_dimacs(graph& g, const char* const begin, const char* const end, const uint threads){
+    read_problem_format(g, begin, end, true, threads);
+  }
+
+  bool read_metis(graph& g, const char* const begin, const char* const end, const uint threads){
+    const char* p(begin);
+    // skip to the header
+    for(skip_blanks(p, end); (p != end) && ((*p == '%') || (*p == '\n')); skip_blanks(p, end)) skip_line(p, end);
+    uint64_t n, m, fmt(0), ncon(1);
+    if(!parse_number(p, end, n) || !parse_number(p, end, m) || (n >= no_index)) return false;
+    if(parse_number(p, end, fmt)) parse_number(p, end, ncon);
+    if(!at_line_end(p, end)) return false;
+    // fmt is up to three binary digits: vertex sizes, vertex weights and edge weights
+    const bool edge_weights(fmt % 10), vertex_weights((fmt / 10) % 10), vertex_sizes((fmt / 100) % 10);
+    if((fmt % 10 > 1) || ((fmt / 10) % 10 > 1) || (fmt / 100 > 1)) return false;
+    const uint skip((vertex_sizes ? 1 : 0) + (vertex_weights ? ncon : 0));
+    skip_line(p, end);
+
+    // line u lists the neighbors of u; to not mistake an edge list for a METIS file, we insist that the neighbors
+    // are exactly what the header promises
+    vector<pair<uint, uint> > ends;
+    // as above, each neighbor takes at least 2 bytes
+    ends.reserve(min<uint64_t>(2 * m, (end - begin) / 2));
+    uint64_t x;
+    for(uint u = 0; u < n; skip_line(p, end)){
+      if(p == end) return false;
+      if(*p == '%') continue;
+      skip_blanks(p, end);
+      for(uint i = 0; i < skip; ++i) if(!parse_number(p, end, x)) return false;
+      while(!at_line_end(p, end)){
+        const uint w(parse_vertex(p, end, n));
+        if((w == no_index) || (edge_weights && !parse_number(p, end, x))) return false;
+        ends.push_back(make_pair(u, w));
+      }
+      ++u;
+    }
+    for(; p != end; skip_line(p, end)){
+      skip_blanks(p, end);
+      if(!at_line_end(p, end) && (*p != '%')) return false;
+    }
+    if(ends.size() != 2 * m) return false;
+    build_graph(g, n, ends, NULL, threads);
+    return true;
+  }
+
+  void read_graph(graph& g, const char* const begin, const char* const end, const uint threads){
+    switch(detect_format(begin, end)){
+      case format_binary: read_binary(g, begin, end); break;
+      case format_pace: read_pace(g, begin, end, threads); break;
+      case format_dimacs: read_dimacs(g, begin, end, threads); break;
+      case format_metis: if(read_metis(g, begin, end, threads)) break; // otherwise, it's an edge list after all
+      default: read_edge_list(g, begin, end, threads);
+    }
+  }
+
+  struct binary_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t n;
+    uint64_t m;
+    uint64_t name_bytes;
+  };
+  static const char binary_magic[4] = {'C', 'R', 'G', 'B'};
+
+  // round up to a multiple of 8
+  inline size_t align8(const size_t x) {return (x + 7) & ~(size_t)7;}
+
+  bool is_binary_graph(const char* const begin, const char* const end){
+    return ((size_t)(end - begin) >= sizeof(binary_header)) && !memcmp(begin, binary_magic, 4);
+  }
+
+  void read_binary(graph& g, const char* const begin, const char* const end){
+    if(!is_binary_graph(begin, end)) INPUT_FAIL("not a binary graph file");
+    binary_header h;
+    memcpy(&h, begin, sizeof(h));
+    if(h.version != binary_version) INPUT_FAIL("cannot read version "<<h.version<<" of the binary graph format");
+    const uint n(h.n);
+    // check m before doubling it, so it cannot overflow into a small number of arcs
+    if(h.m >= no_index / 2) INPUT_FAIL("binary graph file is corrupt: too many edges ("<<h.m<<")");
+    const uint64_t arcs(2 * h.m);
+    // find the sections and make sure they are all there
+    size_t at(sizeof(binary_header));
+    const uint32_t* const offsets((const uint32_t*)(begin + at));
+    at += 4 * ((size_t)n + 1);
+    const uint32_t* const targets((const uint32_t*)(begin + at));
+    at += 4 * arcs;
+    const uint32_t* const ranks((const uint32_t*)(begin + at));
+    at += 4 * arcs;
+    const uint8_t* const arc_flags((h.flags & binary_arc_flags) ? (const uint8_t*)(begin + at) : NULL);
+    if(arc_flags) at += arcs;
+    const uint64_t* name_offsets(NULL);
+    const char* name_data(NULL);
+    if(h.flags & binary_names){
+      at = align8(at);
+      name_offsets = (const uint64_t*)(begin + at);
+      at += 8 * ((size_t)n + 1);
+      name_data = begin + at;
+      if(h.name_bytes > (size_t)(end - begin)) INPUT_FAIL("binary graph file is truncated");
+      at += h.name_bytes;
+    }
+    if(at > (size_t)(end - begin)) INPUT_FAIL("binary graph file is truncated");
+
+    // check everything we are going to index with, so a corrupt file cannot make us read out of bounds
+    if(offsets[0] != 0) INPUT_FAIL("binary graph file is corrupt: the arcs start at "<<offsets[0]);
+    for(uint i = 0; i < n; ++i)
+      if(offsets[i] > offsets[i + 1]) INPUT_FAIL("binary graph file is corrupt: the offsets decrease at vertex "<<i);
+    if(offsets[n] != arcs) INPUT_FAIL("binary graph file is corrupt: "<<offsets[n]<<" arcs instead of "<<arcs);
+    if(name_offsets){
+      if(name_offsets[0] != 0) INPUT_FAIL("binary graph file is corrupt: the names start at "<<name_offsets[0]);
+      for(uint i = 0; i < n; ++i)
+        if(name_offsets[i] > name_offsets[i + 1]) INPUT_FAIL("binary graph file is corrupt: the name offsets decrease at vertex "<<i);
+      if(name_offsets[n] != h.name_bytes) INPUT_FAIL("binary graph file is corrupt: "<<name_offsets[n]<<" bytes of names instead of "<<h.name_bytes);
+    }
+    // put each arc at its rank, which is the index it had in the graph that was written
+    vector<uint> tail(arcs, no_index), head(arcs);
+    vector<bool> permanent(arcs / 2, false);
+    // the last vertex whose adjacency list had an arc to each vertex, to find parallel edges
+    vector<uint> seen_from(n, no_index);
+    for(uint u = 0; u < n; ++u)
+      for(uint a = offsets[u]; a < offsets[u + 1]; ++a){
+        const uint w(targets[a]), r(ranks[a]);
+        if(w >= n) INPUT_FAIL("binary graph file is corrupt: arc "<<a<<" goes to vertex "<<w<<" of "<<n);
+        if(w == u) INPUT_FAIL("binary graph file is corrupt: loop at vertex "<<u);
+        if(seen_from[w] == u) INPUT_FAIL("binary graph file is corrupt: vertices "<<u<<" and "<<w<<" have more than one edge");
+        seen_from[w] = u;
+        if((r >= arcs) || (tail[r] != no_index)) INPUT_FAIL("binary graph file is corrupt: arc "<<a<<" has rank "<<r);
+        tail[r] = u;
+        head[r] = w;
+        if(arc_flags && (arc_flags[a] & 1)) permanent[r / 2] = true;
+      }
+    // the two arcs of each edge have to be reversals of each other
+    for(uint r = 0; r < arcs; r += 2)
+      if((tail[r] != head[r + 1]) || (head[r] != tail[r + 1]))
+        INPUT_FAIL("binary graph file is corrupt: arcs "<<r<<" and "<<r + 1<<" do not form an edge");
+
+    g.build_csr(n, offsets, targets, ranks, &permanent);
+    g.input = make_shared<input_info_t>();
+    // without a name table, the vertices are numbered 1 to n, as in the numbered formats
+    g.input->numbered = (name_data == NULL);
+    if(name_data){
+      g.input->names.reserve(n);
+      for(uint i = 0; i < n; ++i) g.input->names.emplace_back(name_data + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+    }
+    g.set_as_input();
+  }
+
+  void write_binary(const graph& g, ostream& out){
+    // number the vertices in order
+    vector<uint> number(g.current_id, no_index);
+    uint n = 0;
+    for(vertex_pc v = g.vertices.begin(); v != g.vertices.end(); ++v) number[v->id] = n++;
+
+    vector<uint32_t> offsets(1, 0), targets, ranks;
+    vector<uint8_t> arc_flags;
+    vector<uint64_t> name_offsets(1, 0);
+    string name_data;
+    targets.reserve(2 * g.num_edges());
+    ranks.reserve(2 * g.num_edges());
+    arc_flags.reserve(2 * g.num_edges());
+    bool has_flags = false;
+    for(vertex_pc v = g.vertices.begin(); v != g.vertices.end(); ++v){
+      for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e){
+        targets.push_back(number[e->head->id]);
+        ranks.push_back(e.index());
+        arc_flags.push_back(e->is_permanent);
+        has_flags |= e->is_permanent;
+      }
+      offsets.push_back(targets.size());
+      name_data += (string)*v;
+      name_offsets.push_back(name_data.size());
+    }
+    // number the edges in the order of their indices, keeping the direction of each arc
+    vector<uint32_t> edge_index;
+    edge_index.reserve(g.num_edges());
+    for(const uint32_t a : ranks) if(!(a & 1)) edge_index.push_back(a / 2);
+    sort(edge_index.begin(), edge_index.end());
+    for(uint32_t& a : ranks) a = 2 * (lower_bound(edge_index.begin(), edge_index.end(), a / 2) - edge_index.begin()) + (a & 1);
+
+    binary_header h;
+    memcpy(h.magic, binary_magic, 4);
+    h.version = binary_version;
+    h.flags = binary_names | (has_flags ? binary_arc_flags : 0);
+    h.n = n;
+    h.m = targets.size() / 2;
+    h.name_bytes = name_data.size();
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)offsets.data(), 4 * offsets.size());
+    out.write((const char*)targets.data(), 4 * targets.size());
+    out.write((const char*)ranks.data(), 4 * ranks.size());
+    size_t at(sizeof(h) + 4 * (offsets.size() + targets.size() + ranks.size()));
+    if(has_flags){
+      out.write((const char*)arc_flags.data(), arc_flags.size());
+      at += arc_flags.size();
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    out.write(padding, align8(at) - at);
+    out.write((const char*)name_offsets.data(), 8 * name_offsets.size());
+    out.write(name_data.data(), name_data.size());
+  }
+
+}
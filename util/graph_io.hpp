@@ -0,0 +1,79 @@
+#ifndef GRAPH_IO_HPP
+#define GRAPH_IO_HPP
+
+#include "graphs.hpp"
+#include <stdexcept>
+
+namespace cr {
+
+  // the readers report malformed input by throwing this, so that a caller reading many files can go on with the next
+  struct input_error: public std::runtime_error {
+    explicit input_error(const string& what): std::runtime_error(what) {}
+  };
+
+  // a read-only memory map of a whole file, so the readers can tokenize it in place
+  // if the file cannot be mapped (it is empty, a pipe, ...), then ok() is false and the caller should fall back to streams
+  class mapped_file {
+    const char* data;
+    size_t length;
+  public:
+    explicit mapped_file(const char* filename);
+    ~mapped_file();
+
+    inline bool ok() const {return data != NULL;}
+    inline const char* begin() const {return data;}
+    inline const char* end() const {return data + length;}
+  };
+
+  // read g from a list of whitespace-separated pairs of vertex names in [begin, end)
+  // the vertices are numbered in order of first appearance and the edges are added in the order of the input
+  // self-loops and repeated edges are dropped, as is a final name without a partner
+  // large inputs are cut into chunks that are parsed by that many threads (0 = one per core, if the input is large enough)
+  void read_edge_list(graph& g, const char* begin, const char* end, uint threads = 0);
+
+  // the formats we can read; all but the edge list and the binary format number their vertices 1 to n
+  //  PACE:   lines "p <type> n m" (any type but "edge" or "col") and "u v", comment lines start with "c"
+  //  DIMACS: lines "p edge n m" (or "p col n m") and "e u v", comment lines start with "c", other lines are ignored
+  //  METIS:  a header "n m [fmt [ncon]]", followed by one line per vertex listing its neighbors (preceded by its size
+  //          and weights and each followed by the edge weight, according to fmt), comment lines start with "%"
+  enum graph_format {format_edge_list, format_binary, format_pace, format_dimacs, format_metis};
+
+  // guess the format of [begin, end) from its header (in particular, a first line of 2 to 4 numbers is taken for METIS)
+  graph_format detect_format(const char* begin, const char* end);
+  // read g from the format detected in [begin, end), taking METIS files that do not match their header for edge lists
+  // threads is passed on to the readers (0 = one per core, if the input is large enough)
+  void read_graph(graph& g, const char* begin, const char* end, uint threads = 0);
+
+  // read g from the numbered formats above, without giving names to the vertices (see input_info_t::numbered)
+  // self-loops and repeated edges are dropped as in read_edge_list()
+  void read_pace(graph& g, const char* begin, const char* end, uint threads = 0);
+  void read_dimacs(graph& g, const char* begin, const char* end, uint threads = 0);
+  // return false (and leave g alone) if the lines do not match the header
+  bool read_metis(graph& g, const char* begin, const char* end, uint threads = 0);
+
+  // the binary graph format (version 2, all numbers in native byte order):
+  //  header:      the magic "CRGB", then uint32 version, uint32 flags, uint32 n, uint64 m, uint64 size of the name data
+  //  offsets:     n+1 uint32, the arcs of vertex i are targets[offsets[i]] to targets[offsets[i+1]-1]
+  //  targets:     2m uint32, the heads of the arcs, in the order of the adjacency lists
+  //  ranks:       2m uint32, the rank of each arc among all arcs; arcs 2j and 2j+1 are the two directions of edge j
+  //  arc flags:   2m bytes if flags has binary_arc_flags, bit 0 is set for permanent edges
+  //  names:       if flags has binary_names, padding up to a multiple of 8 bytes, then n+1 uint64 offsets into the
+  //               name data, followed by the name data itself
+  const uint binary_version = 2;
+  const uint binary_names = 1;
+  const uint binary_arc_flags = 2;
+
+  // does [begin, end) start like a graph in binary format?
+  bool is_binary_graph(const char* begin, const char* end);
+  // read g from the binary format in [begin, end) (which should be memory mapped) without parsing anything
+  // the arcs get their ranks as indices and the adjacency lists are taken as they are (see graph::build_csr()), so
+  // a graph read from text gets the same arcs and adjacency lists as from the text; without names, the vertices are
+  // numbered 1 to n
+  // a corrupt file is reported with an input_error, we never index outside of [begin, end)
+  void read_binary(graph& g, const char* begin, const char* end);
+  // write g in the binary format, numbering the vertices in the order of g.vertices
+  void write_binary(const graph& g, ostream& out);
+
+}
+
+#endif
@@ -1,28 +1,62 @@
 #include "graphs.hpp"
+#include "intersect.hpp"
+#include "graph_io.hpp"
 #include <unordered_map>
 #include <sstream>
+#include <algorithm>
 
 namespace cr{
 
-  uint hash_edge::operator()(const edge_p& e) const{
-    uint id1(e->head->id);
-    uint id2(e->get_tail()->id);
-    return id1 * max(id1, id2) + id2;
-  }
-
-  // for all j in {0..sizeof(result)-1}:
-  //    let V[j] be the set of vertices whose ID is j modulo sizeof(result)
-  //    let D[j] be the set of last bits of the degrees of all vertices in V[j]
-  //    set j'th most significant bit of result to the parity of D[j]
-  uint hash_graph::operator()(const graph& g) const{
-    uint result = 0;
-    for(auto v = g.vertices.begin(); v != g.vertices.end(); ++v)
-      result ^= ( (v->degree() & 1) << (v->id % (8*sizeof(result))) );
-  // since the sum over all degrees is always even, the parity of result is always even
-  // to compensate for the lost image space, shift it to the left and set the least significant
-  // bit of result to the parity of the vertex set
-    result = ( result << 1 ) | ( g.vertices.size() & 1 );
-    return result;
+  pendant_list::pendant_list(const pendant_list& l):g(l.g),count(l.count),capacity(local_size),store(){
+    if(count > local_size) {
+      capacity = l.capacity;
+      store.heap = new uint[capacity];
+    }
+    std::copy(l.arcs(), l.arcs() + count, arcs());
+  }
+
+  pendant_list& pendant_list::operator=(const pendant_list& l){
+    if(this == &l) return *this;
+    g = l.g;
+    count = 0;
+    while(capacity < l.count) grow();
+    std::copy(l.arcs(), l.arcs() + l.count, arcs());
+    count = l.count;
+    return *this;
+  }
+
+  void pendant_list::grow(){
+    uint* const bigger(new uint[2 * capacity]);
+    std::copy(arcs(), arcs() + count, bigger);
+    if(capacity > local_size) delete[] store.heap;
+    store.heap = bigger;
+    capacity *= 2;
+  }
+
+  void pendant_list::push_back(const edge_p& e){
+    if(count == capacity) grow();
+    uint* const a(arcs());
+    std::copy_backward(a, a + count, a + count + 1);
+    a[0] = e.index();
+    ++count;
+  }
+
+  void pendant_list::truncate(const uint n){
+    if(n >= count) return;
+    uint* const a(arcs());
+    std::copy(a + count - n, a + count, a);
+    count = n;
+  }
+
+  void pendant_list::swap(pendant_list& l){
+    std::swap(g, l.g);
+    std::swap(count, l.count);
+    std::swap(capacity, l.capacity);
+    std::swap(store, l.store);
+  }
+
+  size_t hash_graph::operator()(const graph& g) const{
+    return g.fingerprint();
   }
 
 
@@ -30,16 +64,16 @@ namespace cr{
   bool graph::operator==(const graph& g) const{
     // make sure *this and g have the same # of vertices
     if(vertices.size() != g.vertices.size()) return false;
-    auto v(vertices.begin());
-    auto vprime(g.vertices.begin());
+    vertex_pc v(vertices.begin());
+    vertex_pc vprime(g.vertices.begin());
     while(v != vertices.end()){
       if(v->id != vprime->id) return false;
       if(v->degree() != vprime->degree()) return false;
       // test the sets of incident edges by the ids of the heads
       set<uint> el;
-      for(auto e = v->adj_list.begin(); e != v->adj_list.end(); ++v)
+      for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
         el.insert(e->head->id);
-      for(auto e = v->adj_list.begin(); e != v->adj_list.end(); ++v)
+      for(edge_pc e = vprime->adj_list.begin(); e != vprime->adj_list.end(); ++e)
         if(el.find(e->head->id) == el.end()) return false;
 
       ++v; ++vprime;
@@ -48,14 +82,41 @@ namespace cr{
   }
 
 
-  graph::graph(const graph& g, unordered_map<uint, vertex_p>* id_to_vertex):
+  graph::graph(const graph& g, vector<vertex_p>* id_to_vertex):
     // copy graph infos
+    vertex_store(),
+    arc_store(),
+    present(),
+    trail(),
+    saved_states(),
+    checkpoints(),
+    current_stamp(0),
+    bridge_repairs(),
+    dirty_two_eccs(),
+    next_two_ecc(0),
+    hot_fields(),
+    saved_fields(),
+    tarjan_store(),
+    degree_bucket(),
+    degree_pos(),
+    top_degree(0),
+    high_nldeg(),
+    high_nldeg_pos(),
+    fprint(0),
+    triangle_count(),
+    triangle_corners(0),
+    triangles_indexed(false),
+    tri_nbrs_u(),
+    tri_nbrs_w(),
+    tri_common(),
     current_dfs_id(g.current_dfs_id),
     current_id(0),
-    bridges_marked(g.bridges_marked),
+    bridges_marked(false),
     subtrees_marked(false),
     edgenum(0),
-    cc_number(g.cc_number)
+    cc_number(g.cc_number),
+    vertices(this),
+    input(g.input)
   {
     DEBUG2(cout << "copy constructing a new graph with "<<g.vertices.size()<<" vertices and "<<g.num_edges()<<" edges"<<endl);
     add_disjointly(g, id_to_vertex);
@@ -64,14 +125,41 @@ namespace cr{
   // copy constructor - NOTE THAT trr_infos ARE NOT up to date for the copy
   graph::graph(const graph& g, edgelist* const el):
     // copy graph infos
+    vertex_store(),
+    arc_store(),
+    present(),
+    trail(),
+    saved_states(),
+    checkpoints(),
+    current_stamp(0),
+    bridge_repairs(),
+    dirty_two_eccs(),
+    next_two_ecc(0),
+    hot_fields(),
+    saved_fields(),
+    tarjan_store(),
+    degree_bucket(),
+    degree_pos(),
+    top_degree(0),
+    high_nldeg(),
+    high_nldeg_pos(),
+    fprint(0),
+    triangle_count(),
+    triangle_corners(0),
+    triangles_indexed(false),
+    tri_nbrs_u(),
+    tri_nbrs_w(),
+    tri_common(),
     current_dfs_id(g.current_dfs_id),
     current_id(0),
-    bridges_marked(g.bridges_marked),
+    bridges_marked(false),
     subtrees_marked(false),
     edgenum(0),
-    cc_number(g.cc_number)
+    cc_number(g.cc_number),
+    vertices(this),
+    input(g.input)
   {
-    unordered_map<uint, vertex_p> id_to_vertex;
+    vector<vertex_p> id_to_vertex;
     add_disjointly(g, &id_to_vertex);
     // if we are also tasked with translating the edgelist el, then do so using id_to_vertex
     if(!el->empty()){
@@ -94,79 +182,104 @@ namespace cr{
   }
 
 
-    vertex::vertex(const vertex& v): id(v.id), prot(v.prot), dfs_id(v.dfs_id),
-    incident_bridges(v.incident_bridges),
-    name(v.name),
-    parent_valid(false){}
+  graph::graph(const graph& g, edge_p& e):
+    // copy graph infos
+    vertex_store(),
+    arc_store(),
+    present(),
+    trail(),
+    saved_states(),
+    checkpoints(),
+    current_stamp(0),
+    bridge_repairs(),
+    dirty_two_eccs(),
+    next_two_ecc(0),
+    hot_fields(),
+    saved_fields(),
+    tarjan_store(),
+    degree_bucket(),
+    degree_pos(),
+    top_degree(0),
+    high_nldeg(),
+    high_nldeg_pos(),
+    fprint(0),
+    triangle_count(),
+    triangle_corners(0),
+    triangles_indexed(false),
+    tri_nbrs_u(),
+    tri_nbrs_w(),
+    tri_common(),
+    current_dfs_id(g.current_dfs_id),
+    current_id(0),
+    bridges_marked(false),
+    subtrees_marked(false),
+    edgenum(0),
+    cc_number(g.cc_number),
+    vertices(this),
+    input(g.input)
+  {
+    vector<vertex_p> id_to_vertex;
+    add_disjointly(g, &id_to_vertex);
+    e = convert_edge(e, id_to_vertex);
+  }
+
 
+    edge_p adjacency::found(const uint best, bool *success){
+      if(success) *success = (best != no_index);
+      return edge_p(g, best);
+    }
 
+    // the queries below answer in the order of the segments and stop at the first hit; the segments are permuted by
+    // insertions, removals and reclassifications (so their order is not the adjacency order), but only as determined
+    // by the sequence of modifications, so the answers are the same in every run
     edgelist vertex::get_cyclic_neighbors(){
       edgelist result;
-      // TODO: this is not optimal, maybe maintain a list of cyclic neighbors!
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(!(e->is_bridge)) result.push_back(e);
+      for(uint i = adj_list.core_begin; i < adj_list.segments.size(); ++i)
+        result.push_back(edge_p(adj_list.g, adj_list.segments[i]));
       return result;
     }
 
     edgelist vertex::get_cyclic_core_neighbors(){
       edgelist result;
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
+      for(uint i = adj_list.pendant_end; i < adj_list.segments.size(); ++i){
+        const edge_p e(adj_list.g, adj_list.segments[i]);
         if(e->head->is_on_cyclic_core()) result.push_back(e);
+      }
       return result;
     }
 
     edge_p vertex::first_cyclic_core_neighbor_except(const vertex_p& except, bool *success){
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(e->head->is_on_cyclic_core() && (e->head != except)) {
-          if(success) *success = true;
-          return e;
-        }
-      if(success) *success = false;
-
-      return adj_list.end();
+      for(uint i = adj_list.pendant_end; i < adj_list.segments.size(); ++i){
+        const edge_p e(adj_list.g, adj_list.segments[i]);
+        if(e->head->is_on_cyclic_core() && (e->head != except)) return adj_list.found(e.index(), success);
+      }
+      return adj_list.found(no_index, success);
     }
 
     edge_p vertex::first_cyclic_core_neighbor(bool *success){
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(e->head->is_on_cyclic_core()) {
-          if(success) *success = true;
-          return e;
-        }
-      if(success) *success = false;
-
-      return adj_list.end();
+      for(uint i = adj_list.pendant_end; i < adj_list.segments.size(); ++i)
+        if(edge_p(adj_list.g, adj_list.segments[i])->head->is_on_cyclic_core()) return adj_list.found(adj_list.segments[i], success);
+      return adj_list.found(no_index, success);
     }
 
     edge_p vertex::first_non_bridge_neighbor_except(const vertex_p& except, bool *success){
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(!e->is_bridge && (e->head != except)) {
-          if(success) *success = true;
-          return e;
-        }
-      if(success) *success = false;
-
-      return adj_list.end();
+      for(uint i = adj_list.core_begin; i < adj_list.segments.size(); ++i)
+        if(edge_p(adj_list.g, adj_list.segments[i])->head != except) return adj_list.found(adj_list.segments[i], success);
+      return adj_list.found(no_index, success);
     }
 
     edge_p vertex::first_non_bridge_neighbor(bool *success){
-      for(edge_p e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(!e->is_bridge) {
-          if(success) *success = true;
-          return e;
-        }
-      if(success) *success = false;
-
-      return adj_list.end();
+      return adj_list.found((adj_list.core_begin < adj_list.segments.size()) ? adj_list.segments[adj_list.core_begin] : no_index, success);
     }
 
-    const edge_p& vertex::get_parent(bool *success) {
+    edge_p vertex::get_parent(bool *success) {
       // if we are on the cyclic core, we don't have a parent
       if(!is_on_cyclic_core()){
         DEBUG1(cout << *this << " is not on cylic core since deg = " << degree() << " & subs = " << subtree_NH() << endl);
         // if we already know the parent, just use it
         if(has_parent()) {
           DEBUG1(cout << "I already have a parent" << endl);
-          DEBUG1(cout << "I'll just return "<<*parent->head<<endl);
+          DEBUG1(cout << "I'll just return "<<*edge_p(adj_list.g, adj_list.g->hot_fields[graph::ParentArc][id])->head<<endl);
           if(success) *success = true;
         } else {
           // otherwise, find out the parent
@@ -179,7 +292,7 @@ namespace cr{
               // if we found a parent, register it for later use
               set_parent(e);
               if(success) *success = true;
-              return parent;
+              return e;
             } else DEBUG1(cout << " no..." << endl);
           }
           if(success) *success = false;
@@ -188,18 +301,9 @@ namespace cr{
         DEBUG1(cout << "I'm on the core, no parent for me"<<endl);
         if(success) *success = false;
       }
-      return parent;
-    }
-
-    uint vertex::nldeg() const{
-      uint non_leaves = 0;
-      // note that the trr_infos cannot be trusted because this is being called from TRR6, where trr_infos may be broken
-      for(list<edge>::const_iterator e = adj_list.begin(); e != adj_list.end(); ++e)
-        if(e->head->degree() > 1) non_leaves++;
-      return non_leaves;
+      return edge_p(adj_list.g, adj_list.g->hot_fields[graph::ParentArc][id]);
     }
 
-
     bool vertex::is_separator() const{
       if(cyc_core_degree() != 2) return false;
       if(trr_infos.ptwos.size() > 1) return true;
@@ -209,7 +313,7 @@ namespace cr{
       // only degree-two vertices remain from here on
 
       // find any token-generating neighbors of v
-      for(list<edge>::const_iterator e = adj_list.begin(); e != adj_list.end(); ++e)
+      for(edge_pc e = adj_list.begin(); e != adj_list.end(); ++e)
         if(e->head->is_generator() || (e->head->cyc_core_degree() > 2))
           return false;
       // if noone generates a token, then v is a separator
@@ -217,7 +321,7 @@ namespace cr{
     }
 
     bool vertex::is_incident_to_Bbridge() const{
-      for(list<edge>::const_iterator e = adj_list.begin(); e != adj_list.end(); ++e)
+      for(edge_pc e = adj_list.begin(); e != adj_list.end(); ++e)
         if(e->is_Bbridge()) return true;
       return false;
     }
@@ -248,7 +352,32 @@ namespace cr{
   }
   // clear the graph (remove all vertices and edges)
   void graph::clear(){
-    vertices.clear();
+    // if we have to be able to undo this, then delete the vertices one by one
+    if(logging()){
+      for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) delete_vertex(v);
+      invalidate_bridges();
+      bridges_marked = true;
+      subtrees_marked = true;
+      cc_number = 0;
+      return;
+    }
+    // keep the storage, a graph that is cleared is usually filled again right away (by the readers, for example)
+    vertex_store.reset();
+    arc_store.reset();
+    present.clear();
+    for(vector<uint>& field : hot_fields) field.clear();
+    degree_bucket.clear();
+    degree_pos.clear();
+    top_degree = 0;
+    high_nldeg.clear();
+    high_nldeg_pos.clear();
+    fprint = 0;
+    triangle_count.clear();
+    triangle_corners = 0;
+    triangles_indexed = false;
+    vertices.count = 0;
+    current_id = 0;
+    invalidate_bridges();
     bridges_marked = true;
     subtrees_marked = true;
     edgenum = 0;
@@ -257,70 +386,163 @@ namespace cr{
 
   // find a vertex by specifying its id, return vertices.end() if its just not there
   vertex_p graph::find_vertex_by_id(const uint id){
-    for(vertex_p i = vertices.begin(); i != vertices.end(); ++i)
-      if(i->id == id) return i;
-    return vertices.end();
+    if((id < current_id) && present[id])
+      return vertex_p(this, id);
+    else
+      return vertices.end();
+  }
+
+  // the bucket is in no particular order, so sort the copy to not depend on the history of the graph
+  vector<vertex_p> graph::high_nldeg_vertices(){
+    vector<uint> ids(high_nldeg);
+    std::sort(ids.begin(), ids.end());
+    vector<vertex_p> result;
+    result.reserve(ids.size());
+    for(const uint i : ids) result.emplace_back(this, i);
+    return result;
   }
 
-  // add a vertex with a brand new id to the graph and return a fresh iterator to it
-  // for id, just take the last vertex in the list and increase his id
+  // add a vertex with a brand new id to the graph and return a fresh handle to it
+  // the id is the index of the vertex in the vertex storage
   vertex_p graph::add_vertex_fast(){
-    return add_vertex_fast(++current_id);
+    const uint id(current_id++);
+    vertex_store.emplace_back(this, id);
+    present.push_back(true);
+    vertices.count++;
+    if(triangles_indexed) triangle_count.push_back(0);
+    hot_fields[IncidentBridges].push_back(0);
+    hot_fields[TwoEcc].push_back(no_index);
+    hot_fields[ParentArc].push_back(no_index);
+    index_vertex(vertex_store.back(), true);
+    if(logging()) log(AddVertex, id);
+    // the new vertex is a component of its own
+    if(bridges_marked){
+      hot_fields[TwoEcc].back() = next_two_ecc++;
+      cc_number++;
+    }
+    return vertex_p(this, id);
   }
 
   vertex_p graph::add_vertex_fast(const string& s){
     vertex_p v(add_vertex_fast());
-    v->name = s;
+    v->name = input->names.size();
+    input->names.push_back(s);
     return v;
   }
 
-  // add a vertex given as id to the graph and return a fresh iterator to it
-  vertex_p graph::add_vertex_fast(const uint id){
-    return vertices.insert(vertices.end(), vertex(id));
-  }
-
-  vertex_p graph::add_vertex_fast(const uint id, const string& s){
-    vertex_p v(add_vertex_fast(id));
-    v->name = s;
+  vertex_p graph::add_vertex_fast(const uint name){
+    vertex_p v(add_vertex_fast());
+    v->name = name;
     return v;
   }
 
 
-  // add a vertex given as id to the graph and return a fresh iterator to it
-  // if it was there already, return an iterator to this one!
-  vertex_p graph::add_vertex_secure(const uint id){
-    vertex_p duplicate = find_vertex_by_id(id);
-    if(duplicate == vertices.end())
-      return add_vertex_fast(id);
-    else
-      return duplicate;
+  void graph::reserve(const uint vertices, const uint edges){
+    vertex_store.reserve(current_id + vertices);
+    present.reserve(current_id + vertices);
+    arc_store.reserve(arc_store.size() + 2 * edges);
   }
 
+  void graph::build_csr(const uint n, const uint* const offsets, const uint* const targets, const uint* const ranks,
+                        const vector<bool>* const permanent){
+    clear();
+    const uint arcs(offsets[n]);
+    reserve(n, arcs / 2);
+    for(uint i = 0; i < n; ++i){
+      vertex& v(vertex_store.emplace_back(this, i));
+      v.name = i;
+      v.adj_list.arcs.assign(ranks + offsets[i], ranks + offsets[i + 1]);
+      v.adj_list.segments = v.adj_list.arcs;
+    }
+    // the arcs go into the storage in the order of their ranks, the tail of an arc is the head of its reversal
+    vector<uint> slot(arcs);
+    for(uint s = 0; s < arcs; ++s) slot[ranks[s]] = s;
+    for(uint r = 0; r < arcs; ++r){
+      const uint s(slot[r]);
+      edge& e(arc_store.emplace_back(vertex_p(this, targets[s]), r, s - offsets[targets[slot[r ^ 1]]]));
+      // all arcs start out in the core segment, as they do after invalidate_bridges()
+      e.seg_pos = e.pos;
+      if(permanent && (*permanent)[r / 2]) e.is_permanent = true;
+    }
+    vector<uint>().swap(slot);
+    present.assign(n, true);
+    vertices.count = n;
+    current_id = n;
+    edgenum = arcs / 2;
+    hot_fields[IncidentBridges].assign(n, 0);
+    hot_fields[TwoEcc].resize(n);
+    hot_fields[ParentArc].assign(n, no_index);
+    for(uint i = 0; i < n; ++i) hot_fields[TwoEcc][i] = next_two_ecc++;
+
+    // now that all degrees are known, index each vertex once (see index_vertex(), index_arc() and index_degree()),
+    // reading the heads from the CSR arrays rather than from the arcs
+    degree_pos.assign(n, no_index);
+    high_nldeg_pos.assign(n, no_index);
+    for(uint i = 0; i < n; ++i){
+      vertex& v(vertex_store[i]);
+      const uint d(v.degree());
+      fprint ^= vertex_key(i);
+      for(uint s = offsets[i]; s < offsets[i + 1]; ++s){
+        const uint w(targets[s]);
+        if(offsets[w + 1] - offsets[w] > 1) ++v.non_leaves;
+        if(!(ranks[s] & 1)) fprint ^= edge_key(i, w);
+      }
+      if(degree_bucket.size() <= d) degree_bucket.resize(d + 1);
+      bucket_insert(degree_bucket[d], degree_pos, i);
+      if(d > top_degree) top_degree = d;
+      if(v.non_leaves > 2) bucket_insert(high_nldeg, high_nldeg_pos, i);
+      if(d >= nbr_index_threshold){
+        v.nbr_index.reset(new unordered_map<uint, uint>(2 * d));
+        for(uint s = offsets[i]; s < offsets[i + 1]; ++s) v.nbr_index->emplace(targets[s], ranks[s]);
+      }
+    }
+    // without edges, each vertex is a component of its own and there are no bridges to mark
+    if(arcs){
+      invalidate_bridges();
+      subtrees_marked = false;
+    } else cc_number = n;
+  }
 
   // add an edge to the graph - modify adjacency lists
   // this is the _fast_ variant: no check is done whether this edge already exists!
-  edge_p graph::add_edge_fast(const vertex_p& u, const vertex_p& w){
-    edge eu(u);
-    edge ew(w);
-
+  edge_p graph::add_edge_fast(const vertex_p& u, const vertex_p& w, const uint input_id){
     DEBUG2(cout << "adding edge "<<*u<<"-"<<*w<<endl);
-    edge_p uadj_pos = u->adj_list.insert(u->adj_list.end(), ew);
-    edge_p wadj_pos = w->adj_list.insert(w->adj_list.end(), eu);
+    // the arc u->w lives in u's adjacency list, the arc w->u in w's
+    const uint uw(arc_store.size());
+    vector<uint>& uadj(u->adj_list.arcs);
+    vector<uint>& wadj(w->adj_list.arcs);
+    arc_store.emplace_back(w, uw, uadj.size()).input_id = input_id;
+    uadj.push_back(uw);
+    arc_store.emplace_back(u, uw + 1, wadj.size()).input_id = input_id;
+    wadj.push_back(uw + 1);
+    index_arc(*u, uw);
+    index_arc(*w, uw + 1);
+    segment_insert(*u, uw);
+    segment_insert(*w, uw + 1);
+    update_pendant_arcs(*u);
+    update_pendant_arcs(*w);
+    index_degree(*u, uw, true);
+    index_degree(*w, uw + 1, true);
+    if(triangles_indexed) index_triangles(u.idx, w.idx, 1);
+    if(logging()) log(AddEdge, uw);
 
-    uadj_pos->head_adj_pos = wadj_pos;
-    wadj_pos->head_adj_pos = uadj_pos;
-
-    bridges_marked = false;
     subtrees_marked = false;
     edgenum++;
+    if(bridges_marked){
+      // if we connected an isolated vertex, then the new edge is a bridge joining two components
+      if((uadj.size() == 1) || (wadj.size() == 1)){
+        edge_p(this, uw)->mark_bridge();
+        cc_number--;
+      } else invalidate_bridges();
+    }
 
-    return uadj_pos;
+    return edge_p(this, uw);
   }
 
   edge_p graph::add_edge_fast(const vertex_p& u, const vertex_p& v, const edge_pc& copy_from){
-    edge_p result(add_edge_fast(u, v));
+    edge_p result(add_edge_fast(u, v, copy_from->input_id));
     if(copy_from->is_permanent) result->mark_permanent();
-    if(copy_from->is_bridge) result->mark_bridge();
+    if(copy_from->is_bridge && !result->is_bridge) result->mark_bridge();
     return result;
   }
   // add an edge to the graph - modify adjacency lists
@@ -337,53 +559,389 @@ namespace cr{
   }
 
     // delete a vertex and all incident edge
-    void graph::delete_vertex(const vertex_p& v){
+    void graph::delete_vertex(const vertex_p& _v){
+      // v may be the head of one of the edges we're about to delete, so don't hold a reference to it
+      const vertex_p v(_v);
       DEBUG1(cout << "deleting "<< *v << endl);
-      // delete incident edges
-      while(!v->adj_list.empty()) delete_edge(v->adj_list.begin());
-      // and remove it from the vertex list
-      vertices.erase(v);
+      // delete incident edges, starting from the back, since this does not move any other arcs of v
+      vector<uint>& adj(v->adj_list.arcs);
+      while(!adj.empty()) delete_edge(edge_p(this, adj.back()));
+      // v is isolated now, so it's a component of its own, unless its 2-edge-connected component awaits repair
+      if(bridges_marked && !dirty_two_eccs.count(hot_fields[TwoEcc][v.idx])) cc_number--;
+      // and remove it from the vertex list (its record stays, so the deletion can be undone)
+      index_vertex(*v, false);
+      present[v.idx] = false;
+      vertices.count--;
+      if(logging()) log(DeleteVertex, v.idx);
     }
     void graph::delete_vertices(list<vertex_p>& vl){
       for(list<vertex_p>::iterator v = vl.begin(); v != vl.end(); ++v)
         delete_vertex(*v);
     }
 
-    // delete an edge
-    edge_p graph::delete_edge(const edge_p& e){
-      const edge_p& mirror_e(e->head_adj_pos);
-      
-      DEBUG1(cout << "deleting edge "<< *e << endl);
+    // remove the arc at position pos from an adjacency list, keeping the order of the remaining arcs
+    // (as with the lists we used before, handles to the remaining arcs thus keep their meaning when iterating)
+    void graph::remove_arc(adjacency& adj, const uint pos){
+      vector<uint>& arcs(adj.arcs);
+      arcs.erase(arcs.begin() + pos);
+      for(uint i = pos; i < arcs.size(); ++i)
+        arc_store[arcs[i]].pos = i;
+    }
+
+    // put the arc back at position pos into an adjacency list
+    void graph::insert_arc(adjacency& adj, const uint pos, const uint arc){
+      vector<uint>& arcs(adj.arcs);
+      arcs.insert(arcs.begin() + pos, arc);
+      for(uint i = pos; i < arcs.size(); ++i)
+        arc_store[arcs[i]].pos = i;
+    }
 
-      vertex_p w(e->head);
-      vertex_p u(mirror_e->head);
+    void graph::index_arc(vertex& tail, const uint arc){
+      if(tail.nbr_index)
+        tail.nbr_index->emplace(arc_store[arc].head.idx, arc);
+      else if(tail.degree() >= nbr_index_threshold){
+        tail.nbr_index.reset(new unordered_map<uint, uint>(2 * tail.degree()));
+        for(const uint a : tail.adj_list.arcs)
+          tail.nbr_index->emplace(arc_store[a].head.idx, a);
+      }
+    }
 
-      if(e->is_bridge){
-        u->incident_bridges--;
-        w->incident_bridges--;
-        cc_number++;
+    void graph::unindex_arc(vertex& tail, const uint arc){
+      if(tail.nbr_index){
+        const unordered_map<uint, uint>::iterator i(tail.nbr_index->find(arc_store[arc].head.idx));
+        if((i != tail.nbr_index->end()) && (i->second == arc)) tail.nbr_index->erase(i);
+      }
+    }
+
+    void graph::segment_swap(adjacency& adj, const uint i, const uint j){
+      vector<uint>& seg(adj.segments);
+      std::swap(seg[i], seg[j]);
+      arc_store[seg[i]].seg_pos = i;
+      arc_store[seg[j]].seg_pos = j;
+    }
+
+    // new arcs start out as non-bridges at the end of the segments and are then moved to their segment
+    void graph::segment_insert(vertex& tail, const uint arc){
+      vector<uint>& seg(tail.adj_list.segments);
+      arc_store[arc].seg_pos = seg.size();
+      seg.push_back(arc);
+      classify_arc(arc);
+    }
+
+    void graph::segment_remove(vertex& tail, const uint arc){
+      adjacency& adj(tail.adj_list);
+      edge& e(arc_store[arc]);
+      // move the arc to the border of its segment and shrink the segment, until it's the last non-bridge
+      if(e.seg_pos < adj.pendant_end) segment_swap(adj, e.seg_pos, --adj.pendant_end);
+      if(e.seg_pos < adj.core_begin) segment_swap(adj, e.seg_pos, --adj.core_begin);
+      segment_swap(adj, e.seg_pos, adj.segments.size() - 1);
+      adj.segments.pop_back();
+      e.seg_pos = no_index;
+    }
+
+    void graph::classify_arc(const uint arc){
+      edge& e(arc_store[arc]);
+      if(e.seg_pos == no_index) return;
+      adjacency& adj(vertex_store[arc_store[arc ^ 1].head.idx].adj_list);
+      // segments: 0 = pendant, 1 = bridge, 2 = core
+      const uint target(e.is_bridge ? (vertex_store[e.head.idx].degree() == 1 ? 0 : 1) : 2);
+      uint current((e.seg_pos < adj.pendant_end) ? 0 : ((e.seg_pos < adj.core_begin) ? 1 : 2));
+      // to move up, swap with the last arc of the segment and let the next segment start one earlier
+      for(; current < target; ++current){
+        uint& border(current ? adj.core_begin : adj.pendant_end);
+        segment_swap(adj, e.seg_pos, --border);
+      }
+      // to move down, swap with the first arc of the segment and let the previous segment end one later
+      for(; current > target; --current){
+        uint& border((current == 2) ? adj.core_begin : adj.pendant_end);
+        segment_swap(adj, e.seg_pos, border++);
+      }
+    }
+
+    void graph::update_pendant_arcs(vertex& v){
+      // only the degrees 1 and 2 can be reached from or lead to degree 1, and only bridges can be pendant
+      if(v.degree() <= 2)
+        for(const uint a : v.adj_list.arcs)
+          if(arc_store[a].is_bridge) classify_arc(a ^ 1);
+    }
+
+    void graph::index_degree(vertex& tail, const uint arc, const bool added){
+      const vector<uint>& arcs(tail.adj_list.arcs);
+      const uint d(tail.degree());
+      vertex& head(vertex_store[arc_store[arc].head.idx]);
+      // the edge enters (or leaves) the fingerprint with its first arc
+      if(!(arc & 1)) fprint ^= edge_key(tail.id, head.id);
+      if(added){
+        change_degree(tail.id, d - 1, d);
+        // the arc counts for the tail if the head is not a leaf, and if the tail just stopped being a leaf,
+        // then it now counts for its other neighbor (the head sees this when the reverse arc is indexed)
+        if(head.degree() > 1) add_to_nldeg(tail, 1);
+        if(d == 2) add_to_nldeg(vertex_store[arc_store[arcs[arcs[0] == arc]].head.idx], 1);
+      } else {
+        change_degree(tail.id, d + 1, d);
+        // the arc counted for the tail if the head was not a leaf before, and if the tail just became a leaf,
+        // then it no longer counts for its remaining neighbor
+        if(head.degree() > 0) add_to_nldeg(tail, -1);
+        if(d == 1) add_to_nldeg(vertex_store[arc_store[arcs[0]].head.idx], -1);
+      }
+    }
+
+    void graph::index_vertex(const vertex& v, const bool present){
+      const uint d(v.degree());
+      fprint ^= vertex_key(v.id);
+      for(const uint a : v.adj_list.arcs)
+        if(!(a & 1)) fprint ^= edge_key(v.id, arc_store[a].head.idx);
+      if(present){
+        if(degree_pos.size() <= v.id){
+          degree_pos.resize(current_id, no_index);
+          high_nldeg_pos.resize(current_id, no_index);
+        }
+        if(degree_bucket.size() <= d) degree_bucket.resize(d + 1);
+        bucket_insert(degree_bucket[d], degree_pos, v.id);
+        if(d > top_degree) top_degree = d;
+        if(v.non_leaves > 2) bucket_insert(high_nldeg, high_nldeg_pos, v.id);
+        if(triangles_indexed) triangle_corners += triangle_count[v.id];
+      } else {
+        bucket_remove(degree_bucket[d], degree_pos, v.id);
+        while(top_degree && degree_bucket[top_degree].empty()) --top_degree;
+        if(v.non_leaves > 2) bucket_remove(high_nldeg, high_nldeg_pos, v.id);
+        if(triangles_indexed) triangle_corners -= triangle_count[v.id];
+      }
+    }
+
+    void graph::sorted_neighbors(const vertex& v, vector<uint>& nbrs) const {
+      nbrs.clear();
+      for(const uint a : v.adj_list.arcs) nbrs.push_back(arc_store[a].head.idx);
+      std::sort(nbrs.begin(), nbrs.end());
+    }
+
+    void graph::index_triangles(const uint u, const uint w, const int diff, const unordered_set<uint>* const gone){
+      // the triangles of the edge are the common neighbors of its endpoints
+      const uint du(vertex_store[u].degree());
+      const uint dw(vertex_store[w].degree());
+      if((min(du, dw) >= intersect_min_length) && (max(du, dw) <= intersect_skew * min(du, dw))){
+        // if the degrees are large and about the same, intersect the sorted lists of neighbors
+        sorted_neighbors(vertex_store[u], tri_nbrs_u);
+        sorted_neighbors(vertex_store[w], tri_nbrs_w);
+        tri_common.resize(min(du, dw));
+        const uint found(intersect_sorted(tri_nbrs_u.data(), du, tri_nbrs_w.data(), dw, tri_common.data()));
+        int counted(0);
+        for(uint i = 0; i < found; ++i){
+          const uint x(tri_common[i]);
+          // in a batch of deletions, skip the triangles that the deletion of an earlier edge has already accounted for
+          if(gone && (gone->count(find_edge(vertex_p(this, u), vertex_p(this, x)).idx >> 1)
+                   || gone->count(find_edge(vertex_p(this, w), vertex_p(this, x)).idx >> 1))) continue;
+          triangle_count[x] += diff;
+          ++counted;
+        }
+        triangle_count[u] += diff * counted;
+        triangle_count[w] += diff * counted;
+        triangle_corners += 3 * diff * counted;
+        return;
+      }
+      // otherwise, run through the neighbors of the endpoint of smaller degree and ask the other endpoint
+      // (or the neighbor, if that's cheaper) whether they are adjacent
+      const vertex_p a(this, (du <= dw) ? u : w);
+      const vertex_p b(this, (du <= dw) ? w : u);
+      for(const uint arc : a->adj_list.arcs){
+        const vertex_p x(arc_store[arc].head);
+        if(x == b) continue;
+        if(x->degree() < b->degree() ? adjacent(x, b) : adjacent(b, x)){
+          if(gone && (gone->count(arc >> 1) || gone->count(find_edge(b, x).idx >> 1))) continue;
+          triangle_count[u] += diff;
+          triangle_count[w] += diff;
+          triangle_count[x.idx] += diff;
+          triangle_corners += 3 * diff;
+        }
+      }
+    }
+
+    // list each triangle once, from its two vertices u < w of smaller index, by intersecting the sorted lists of
+    // the neighbors of u and w that come after w
+    // vertices that have been moved to another graph keep their adjacencies and come back on rollback, so count their
+    // triangles too (but not in triangle_corners, since they are not present)
+    void graph::build_triangle_index(){
+      vector<uint> first(current_id + 1, 0);
+      for(uint i = 0; i < current_id; ++i) first[i + 1] = first[i] + vertex_store[i].degree();
+      vector<uint> nbrs(first.back());
+      uint max_deg(0);
+      for(uint i = 0; i < current_id; ++i){
+        uint* const begin(nbrs.data() + first[i]);
+        uint* end(begin);
+        for(const uint a : vertex_store[i].adj_list.arcs) *(end++) = arc_store[a].head.idx;
+        std::sort(begin, end);
+        max_deg = max(max_deg, vertex_store[i].degree());
       }
 
-      list<edge>& wadj(w->adj_list);
-      list<edge>& uadj(u->adj_list);
+      vector<uint> common(max_deg);
+      triangle_count.assign(current_id, 0);
+      for(uint u = 0; u < current_id; ++u)
+        for(uint p = first[u]; p < first[u + 1]; ++p){
+          const uint w(nbrs[p]);
+          if(w < u) continue;
+          const uint* const w_begin(nbrs.data() + first[w]);
+          const uint* const w_end(nbrs.data() + first[w + 1]);
+          const uint* const w_later(std::upper_bound(w_begin, w_end, w));
+          const uint found(intersect_sorted(nbrs.data() + p + 1, first[u + 1] - p - 1, w_later, w_end - w_later, common.data()));
+          triangle_count[u] += found;
+          triangle_count[w] += found;
+          for(uint i = 0; i < found; ++i) ++triangle_count[common[i]];
+        }
+      triangle_corners = 0;
+      for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) triangle_corners += triangle_count[v.idx];
+      triangles_indexed = true;
+    }
+
+    // everything that deleting the edge of the given arc entails, except for changing the adjacency lists and indices
+    void graph::account_deletion(const uint arc){
+      edge& uw(arc_store[arc]);
+      const vertex_p w(uw.head);
+      const vertex_p u(arc_store[arc ^ 1].head);
+
+      if(uw.is_bridge){
+        // (this is undone along with the deletion, so it's not logged)
+        hot_fields[IncidentBridges][u.idx]--;
+        hot_fields[IncidentBridges][w.idx]--;
+        cc_number++;
+      } else if(bridges_marked){
+        // the 2-edge-connected component of u and w might fall apart, we'll look for new bridges in it when asked
+        bridge_repairs.push_back(u.idx);
+        bridge_repairs.push_back(w.idx);
+        dirty_two_eccs.insert(hot_fields[TwoEcc][u.idx]);
+      }
 
       // take care of parent
-      if(u->has_parent()) if(u->parent->head == w) u->invalidate_parent();
-      if(w->has_parent()) if(w->parent->head == u) w->invalidate_parent();
+      const uint u_parent(hot_fields[ParentArc][u.idx]), w_parent(hot_fields[ParentArc][w.idx]);
+      if((u_parent != no_index) && (arc_store[u_parent].head == w)) u->invalidate_parent();
+      if((w_parent != no_index) && (arc_store[w_parent].head == u)) w->invalidate_parent();
 
       // don't forget to update graph variables
       edgenum--;
-      bridges_marked = false;
       subtrees_marked = false;
+    }
+
+    // delete an edge
+    edge_p graph::delete_edge(const edge_p& e){
+      edge& uw(arc_store[e.idx]);
+      edge& wu(arc_store[e.idx ^ 1]);
+
+      DEBUG1(cout << "deleting edge "<< *e << endl);
+
+      const vertex_p w(uw.head);
+      const vertex_p u(wu.head);
+
+      account_deletion(e.idx);
 
       // perform the delete and return the next edge_p "in line"
-      uadj.erase(mirror_e);
-      return wadj.erase(e);
+      const uint pos(uw.pos);
+      if(logging()) log(DeleteEdge, e.idx, uw.pos, wu.pos);
+      remove_arc(u->adj_list, uw.pos);
+      remove_arc(w->adj_list, wu.pos);
+      unindex_arc(*u, e.idx);
+      unindex_arc(*w, e.idx ^ 1);
+      segment_remove(*u, e.idx);
+      segment_remove(*w, e.idx ^ 1);
+      uw.pos = wu.pos = no_index;
+      update_pendant_arcs(*u);
+      update_pendant_arcs(*w);
+      index_degree(*u, e.idx, false);
+      index_degree(*w, e.idx ^ 1, false);
+      if(triangles_indexed) index_triangles(u.idx, w.idx, -1);
+
+      const vector<uint>& uadj(u->adj_list.arcs);
+      return edge_p(this, (pos < uadj.size()) ? uadj[pos] : no_index);
     }
 
+    // delete all edges of l, compacting each adjacency list only once instead of once per deleted arc
+    // the trail gets the same entries as if the edges had been deleted one after the other, so rollback() undoes them
+    // one by one as usual; the degree index is repaired once for the touched vertices in the end
     void graph::delete_edges(const edgelist& l){
-      for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e)
-        delete_edge(*e);
+      if(l.size() < 2){
+        for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e)
+          delete_edge(*e);
+        return;
+      }
+      DEBUG1(cout << "deleting edges "<< l << endl);
+
+      // first, do the bookkeeping while the adjacency lists are still intact, and collect the arcs with their tails
+      vector<pair<uint, uint> > tail_arcs;
+      tail_arcs.reserve(2 * l.size());
+      unordered_set<uint> gone;
+      for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e){
+        const uint arc(e->idx);
+        const uint u(arc_store[arc ^ 1].head.idx), w(arc_store[arc].head.idx);
+        account_deletion(arc);
+        fprint ^= edge_key(u, w);
+        if(triangles_indexed){
+          index_triangles(u, w, -1, &gone);
+          gone.insert(arc >> 1);
+        }
+        tail_arcs.emplace_back(u, arc);
+        tail_arcs.emplace_back(w, arc ^ 1);
+      }
+
+      // second, remove the arcs of each tail in one go (they stay in the order of l in each group)
+      // in the position of each removed arc, we remember where it would have been removed if we had gone one by one:
+      // that's its position, minus the number of arcs before it that have been removed before it
+      std::stable_sort(tail_arcs.begin(), tail_arcs.end(),
+          [](const pair<uint, uint>& x, const pair<uint, uint>& y){ return x.first < y.first; });
+      // (we don't mark the touched vertices with a dfs_id, since we may be called in the middle of somebody's DFS)
+      vector<pair<uint, uint> > touched; // (tail, old degree), sorted by tail
+      vector<uint> removed;
+      for(uint i = 0; i < tail_arcs.size();){
+        vertex& t(vertex_store[tail_arcs[i].first]);
+        touched.emplace_back(t.id, t.degree());
+        removed.clear();
+        for(; (i < tail_arcs.size()) && (tail_arcs[i].first == t.id); ++i){
+          edge& e(arc_store[tail_arcs[i].second]);
+          const uint pos(e.pos);
+          for(const uint p : removed) if(p < pos) --e.pos;
+          removed.push_back(pos);
+          unindex_arc(t, tail_arcs[i].second);
+          segment_remove(t, tail_arcs[i].second);
+        }
+        std::sort(removed.begin(), removed.end());
+        vector<uint>& arcs(t.adj_list.arcs);
+        uint kept(0);
+        vector<uint>::const_iterator next_removed(removed.begin());
+        for(uint j = 0; j < arcs.size(); ++j)
+          if((next_removed != removed.end()) && (*next_removed == j)) ++next_removed; else {
+            arcs[kept] = arcs[j];
+            arc_store[arcs[kept]].pos = kept;
+            ++kept;
+          }
+        arcs.resize(kept);
+      }
+
+      // third, log the deletions in the order of l
+      for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e){
+        edge& uw(arc_store[e->idx]);
+        edge& wu(arc_store[e->idx ^ 1]);
+        if(logging()) log(DeleteEdge, e->idx, uw.pos, wu.pos);
+        uw.pos = wu.pos = no_index;
+      }
+
+      // finally, repair the indices: first, tell untouched neighbors that a touched vertex became a leaf,
+      // then recount the nldegs of the touched vertices (their neighbors have their final degrees by now)
+      for(const pair<uint, uint>& td : touched){
+        vertex& t(vertex_store[td.first]);
+        change_degree(t.id, td.second, t.degree());
+        if((td.second > 1) && (t.degree() <= 1))
+          for(const uint a : t.adj_list.arcs){
+            const uint x(arc_store[a].head.idx);
+            const pair<uint, uint> key(x, 0);
+            const vector<pair<uint, uint> >::const_iterator i(std::lower_bound(touched.begin(), touched.end(), key));
+            if((i == touched.end()) || (i->first != x)) add_to_nldeg(vertex_store[x], -1);
+          }
+      }
+      for(const pair<uint, uint>& td : touched){
+        vertex& t(vertex_store[td.first]);
+        uint non_leaves(0);
+        for(const uint a : t.adj_list.arcs)
+          if(vertex_store[arc_store[a].head.idx].degree() > 1) ++non_leaves;
+        add_to_nldeg(t, (int)non_leaves - (int)t.non_leaves);
+        update_pendant_arcs(t);
+      }
     }
 
     // delete the connected component containing vertex v
@@ -392,14 +950,13 @@ namespace cr{
       DEBUG1(cout << "destroying component of " << *v << endl);
       uint dfs_id = get_dfs_id();
 
-      list<vertex_p> to_destroy;
+      vector<vertex_p> to_destroy;
       to_destroy.push_back(v);
       v->dfs_id = dfs_id;
 
       // destroy the component via BFS
-      while(!to_destroy.empty()){
-        vertex_p u(to_destroy.front());
-        to_destroy.pop_front();
+      for(uint i = 0; i < to_destroy.size(); ++i){
+        const vertex_p u(to_destroy[i]);
 
         // add all neighbors...
         for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
@@ -412,10 +969,169 @@ namespace cr{
         // and destroy u
         delete_vertex(u);
       }
-      cc_number--;
     }
 
 
+  void graph::checkpoint(){
+    // the repairs of the bridges cannot be rolled back, so do them now
+    if(!bridge_repairs.empty()) repair_bridges();
+    checkpoint_t cp = {(uint)trail.size(), ++current_stamp, current_id, edgenum, cc_number, bridges_marked, subtrees_marked};
+    checkpoints.push_back(cp);
+  }
+
+  void graph::rollback(){
+    const checkpoint_t& cp(checkpoints.back());
+    // undo all modifications since the checkpoint in reverse order
+    while(trail.size() > cp.trail_size){
+      undo(trail.back());
+      trail.pop_back();
+    }
+    edgenum = cp.edgenum;
+    cc_number = cp.cc_number;
+    bridges_marked = cp.bridges_marked;
+    subtrees_marked = cp.subtrees_marked;
+    // all repairs since the checkpoint have been undone and there were none pending at the checkpoint
+    bridge_repairs.clear();
+    dirty_two_eccs.clear();
+    checkpoints.pop_back();
+  }
+
+  void graph::save_vertex_state(vertex& v){
+    if(!logging()) return;
+    const checkpoint_t& cp(checkpoints.back());
+    // nothing to do if v has been saved since the last checkpoint or if v will be removed on rollback anyways
+    if((v.saved_at == cp.stamp) || (v.id >= cp.current_id)) return;
+    log(VertexState, v.id, v.saved_at);
+    saved_states.push_back(vertex_state(v));
+    v.saved_at = cp.stamp;
+  }
+
+  void graph::replace_field(const hot_field f, vector<uint>& values){
+    hot_fields[f].swap(values);
+    if(logging()){
+      log(FieldArray, f);
+      saved_fields.push_back(vector<uint>());
+      saved_fields.back().swap(values);
+    }
+  }
+
+  void graph::reset_subtrees(){
+    // the parents are reset in one go, if there are any
+    const vector<uint>& parents(hot_fields[ParentArc]);
+    if(std::find_if(parents.begin(), parents.end(), [](const uint a){ return a != no_index; }) != parents.end()){
+      vector<uint> none(parents.size(), no_index);
+      replace_field(ParentArc, none);
+    }
+    // the trr_infos of a vertex that has not been saved since the last checkpoint move to the trail as they are
+    const bool log_states(logging());
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v)
+      if(!v->trr_infos.empty()){
+        if(log_states && (v->saved_at != checkpoints.back().stamp) && (v->id < checkpoints.back().current_id)){
+          log(VertexState, v->id, v->saved_at);
+          saved_states.push_back(vertex_state(*v, true));
+          v->saved_at = checkpoints.back().stamp;
+        } else v->trr_infos.clear();
+      }
+  }
+
+  void graph::save_arc_flags(const edge& e){
+    if(!logging()) return;
+    const edge& rev(arc_store[e.index ^ 1]);
+    const uint flags(e.is_bridge | (e.is_permanent << 1) | (rev.is_bridge << 2) | (rev.is_permanent << 3));
+    log(ArcFlags, e.index, flags, e.input_id);
+  }
+
+  // undo a single modification; all modifications after it have already been undone
+  void graph::undo(const trail_entry& t){
+    switch(t.op){
+      case AddVertex:
+        index_vertex(vertex_store.back(), false);
+        if(triangles_indexed) triangle_count.pop_back();
+        vertex_store.pop_back();
+        present.pop_back();
+        for(vector<uint>& field : hot_fields) field.pop_back();
+        current_id--;
+        vertices.count--;
+        break;
+      case DeleteVertex:
+        present[t.index] = true;
+        vertices.count++;
+        index_vertex(vertex_store[t.index], true);
+        break;
+      case AddEdge: {
+          // the new arcs are the last ones in the storage and in both adjacency lists
+          vertex& u(vertex_store[arc_store[t.index ^ 1].head.idx]);
+          vertex& w(vertex_store[arc_store[t.index].head.idx]);
+          unindex_arc(u, t.index);
+          unindex_arc(w, t.index ^ 1);
+          segment_remove(u, t.index);
+          segment_remove(w, t.index ^ 1);
+          u.adj_list.arcs.pop_back();
+          w.adj_list.arcs.pop_back();
+          update_pendant_arcs(u);
+          update_pendant_arcs(w);
+          index_degree(u, t.index, false);
+          index_degree(w, t.index ^ 1, false);
+          if(triangles_indexed) index_triangles(u.id, w.id, -1);
+          arc_store.pop_back();
+          arc_store.pop_back();
+        }
+        break;
+      case DeleteEdge: {
+          edge& uw(arc_store[t.index]);
+          edge& wu(arc_store[t.index ^ 1]);
+          vertex& u(vertex_store[wu.head.idx]);
+          vertex& w(vertex_store[uw.head.idx]);
+          insert_arc(u.adj_list, t.a, t.index);
+          insert_arc(w.adj_list, t.b, t.index ^ 1);
+          index_arc(u, t.index);
+          index_arc(w, t.index ^ 1);
+          segment_insert(u, t.index);
+          segment_insert(w, t.index ^ 1);
+          update_pendant_arcs(u);
+          update_pendant_arcs(w);
+          index_degree(u, t.index, true);
+          index_degree(w, t.index ^ 1, true);
+          if(triangles_indexed) index_triangles(u.id, w.id, 1);
+          if(uw.is_bridge){
+            hot_fields[IncidentBridges][u.id]++;
+            hot_fields[IncidentBridges][w.id]++;
+          }
+        }
+        break;
+      case ArcFlags: {
+          edge& uw(arc_store[t.index]);
+          edge& wu(arc_store[t.index ^ 1]);
+          uw.is_bridge = t.a & 1;
+          uw.is_permanent = t.a & 2;
+          wu.is_bridge = t.a & 4;
+          wu.is_permanent = t.a & 8;
+          uw.input_id = wu.input_id = t.b;
+          classify_arc(t.index);
+          classify_arc(t.index ^ 1);
+        }
+        break;
+      case VertexState: {
+          vertex& v(vertex_store[t.index]);
+          vertex_state& st(saved_states.back());
+          v.prot = st.prot;
+          v.name = st.name;
+          v.trr_infos.swap(st.trr_infos);
+          v.saved_at = t.a;
+          saved_states.pop_back();
+        }
+        break;
+      case FieldValue:
+        hot_fields[t.a][t.index] = t.b;
+        break;
+      case FieldArray:
+        hot_fields[t.index].swap(saved_fields.back());
+        saved_fields.pop_back();
+        break;
+    }
+  }
+
+
   // simple output,
   // Prints the edgelist of g (plus the number of vertices/edges in verbose mode)
   // g: a graph
@@ -428,14 +1144,13 @@ namespace cr{
       out<<"number of edges: "<<    num_edges() <<endl;
     }
   
-    set<vertex> seen;
-    for(list<vertex>::const_iterator v = vertices.begin(); v != vertices.end(); ++v){
+    vector<bool> seen(current_id, false);
+    for(vertex_pc v = vertices.begin(); v != vertices.end(); ++v){
       // mark v 'seen' so no edges involving v are printed later
-      //std::pair<set<vertex>::iterator, bool> seen_entry = 
-        seen.insert(*v);
-      for(list<edge>::const_iterator e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+      seen[v->id] = true;
+      for(edge_pc e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
         // if v's current head has not been 'seen' yet, print the edge
-        if(seen.find(*(e->head)) == seen.end()){
+        if(!seen[e->head->id]){
           out<< *e;
           if(verbose){
             if(e->is_permanent) out << " (P)";
@@ -446,80 +1161,131 @@ namespace cr{
     }
   } // end write_graph
 
+  void graph::write_solution(ostream& out, const solution_t& sol) const{
+    out << '(';
+    for(const uint e : sol)
+      if(e == no_index) out << "? "; else {
+        const pair<uint, uint>& uv(input->edges[e]);
+        out << input->name(uv.first) << "->" << input->name(uv.second) << ' ';
+      }
+    out << ')';
+  }
+
 
   // simple input
   // reads the edgelist into g
   // in: input stream. 
   void graph::read_from_stream(istream& in){
-    typedef unordered_map<string, vertex_p>::iterator map_iter;
-    
-    unordered_map<string, vertex_p> id2vertex;
-    string name0,name1;
-    pair<map_iter, bool> i,j;
-
-    // clear the graph
-    clear();
+    const string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    read_graph(*this, content.data(), content.data() + content.size());
+  } // end of read_graph
 
-    while(in){
-      // read the two endpoints
-      in >> name0;
-      in >> name1;
 
-      // get their respective vertices (or create if they don't exist yet)
-      i = id2vertex.insert(pair<string, vertex_p>(name0,vertex_p()));
-      if(i.second) { // new vertex
-        i.first->second = add_vertex_fast();
-        i.first->second->name = name0;
-      }
-      j = id2vertex.insert(make_pair(name1,vertex_p()));
-      if(j.second) { // new vertex
-        j.first->second = add_vertex_fast();
-        j.first->second->name = name1;
+  void graph::set_as_input(){
+    // the names of the heads come from a copy, visiting the (much larger) vertices for each arc would miss the cache
+    vector<uint> name_of(current_id, no_index);
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) name_of[v.idx] = v->name;
+    input->edges.clear();
+    input->edges.reserve(edgenum);
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v)
+      for(const uint a : v->adj_list.arcs){
+        edge& e(arc_store[a]);
+        if(e.head.idx > v.idx){
+          save_arc_flags(e);
+          e.input_id = arc_store[a ^ 1].input_id = input->edges.size();
+          input->edges.push_back(make_pair(name_of[v.idx], name_of[e.head.idx]));
+        }
       }
-      add_edge_secure(i.first->second,j.first->second);
-    }
-  } // end of read_graph
+  }
 
+  void graph::rebuild_input(){
+    const shared_ptr<input_info_t> info(input);
+    clear();
+    input = info;
+    uint n(input->names.size());
+    for(const pair<uint, uint>& uw : input->edges) n = max(n, max(uw.first, uw.second) + 1);
+    reserve(n, input->edges.size());
+    // the names of the vertices of the input are their indices, so they get their names back as ids
+    for(uint i = 0; i < n; ++i) add_vertex_fast(i);
+    for(uint e = 0; e < input->edges.size(); ++e)
+      add_edge_fast(vertex_p(this, input->edges[e].first), vertex_p(this, input->edges[e].second), e);
+  }
 
   // simple input
   // reads the edgelist into f
   // infile: input file namf
-  void graph::read_from_file(const char* infile)
+  void graph::read_from_file(const char* infile, const uint threads)
   {
-    ifstream f(infile);
-    read_from_stream(f);
+    const mapped_file mf(infile);
+    if(mf.ok()) read_graph(*this, mf.begin(), mf.end(), threads); else {
+      ifstream f(infile);
+      read_from_stream(f);
+    }
   }
 
 
 // my own bridge finder, takes linear time and less space per vertex
 // this also outputs for each bridge b the number of vertices in the one of the two(!)
 // components split off by deleting b
-  uint my_bridge_finder(const vertex_p& v, const vertex_p& parent, uint dfs_id, edgelist& bridgelist, list<uint>& comp_sizes){
-    v->tarjan_infos.number = parent->tarjan_infos.number + 1;
-    v->incident_bridges = 0;
-    v->dfs_id = dfs_id;
-    uint subtree_size = 1;
-    edge_p to_parent;
-    uint smallest_num = INT_MAX;
-
-    for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e) if(e->head != parent){
-      const vertex_p& w(e->head);
-      if(w->dfs_id != dfs_id){ // this is a forward edge
-        // recurse, saving the number of vertices in the sub-DFS-tree
-        subtree_size += my_bridge_finder(w, v, dfs_id, bridgelist, comp_sizes);
-        // after recursion, we know whether e is a bridge or not
-        if(!e->is_bridge) smallest_num = min(smallest_num, w->tarjan_infos.number);
-      } else smallest_num = min(smallest_num, w->tarjan_infos.number);
-    } else to_parent = e; // save the edge to the parent in case we want to mark it as bridge
-    v->tarjan_infos.number = smallest_num;
-    // if parent's number is still smaller than v's, then {v,parent} is indeed a bridge
-    if(parent->tarjan_infos.number < smallest_num) {
-      DEBUG1(cout << "found bridge: " << v<<"->"<<parent<< " splitting away "<< subtree_size <<" vertices"<< endl);
-      to_parent->mark_bridge();
-      bridgelist.push_back(to_parent);
-      comp_sizes.push_back(subtree_size);
-    }
-    // in any case, return the number of vertices in this DFS subtree
+// the DFS uses an explicit stack instead of recursion, since long paths would overflow the call stack
+  uint my_bridge_finder(const vertex_p& root, const vertex_p& root_parent, uint dfs_id, edgelist& bridgelist, list<uint>& comp_sizes){
+    // what the recursive version kept on the call stack
+    struct frame_t{
+      vertex_p v, parent;
+      edge_p e, to_parent;
+      uint smallest_num, subtree_size;
+    };
+    vector<frame_t> stack;
+    graph& g(*root.get_graph());
+    uint subtree_size = 0;
+
+    // "call" for root
+    g.tarjan_infos(root).number = g.tarjan_infos(root_parent).number + 1;
+    g.hot_fields[graph::IncidentBridges][root.index()] = 0;
+    root->dfs_id = dfs_id;
+    stack.push_back(frame_t{root, root_parent, root->adj_list.begin(), edge_p(), INT_MAX, 1});
+    while(!stack.empty()){
+      frame_t& f(stack.back());
+      if(f.e != f.v->adj_list.end()){
+        const edge_p e(f.e);
+        if(e->head != f.parent){
+          const vertex_p& w(e->head);
+          if(w->dfs_id != dfs_id){ // this is a forward edge
+            // "recurse", the frame of v continues with e once w is done
+            g.tarjan_infos(w).number = g.tarjan_infos(f.v).number + 1;
+            g.hot_fields[graph::IncidentBridges][w.index()] = 0;
+            w->dfs_id = dfs_id;
+            const vertex_p v(f.v);
+            stack.push_back(frame_t{w, v, w->adj_list.begin(), edge_p(), INT_MAX, 1});
+            continue;
+          } else f.smallest_num = min(f.smallest_num, g.tarjan_infos(w).number);
+        } else f.to_parent = e; // save the edge to the parent in case we want to mark it as bridge
+        ++f.e;
+      } else {
+        // "return" from v
+        const vertex_p& v(f.v);
+        g.tarjan_infos(v).number = f.smallest_num;
+        // if parent's number is still smaller than v's, then {v,parent} is indeed a bridge
+        if(g.tarjan_infos(f.parent).number < f.smallest_num) {
+          DEBUG1(cout << "found bridge: " << v<<"->"<<f.parent<< " splitting away "<< f.subtree_size <<" vertices"<< endl);
+          f.to_parent->mark_bridge();
+          bridgelist.push_back(f.to_parent);
+          comp_sizes.push_back(f.subtree_size);
+        }
+        subtree_size = f.subtree_size;
+        const uint number(g.tarjan_infos(v).number);
+        stack.pop_back();
+        if(!stack.empty()){
+          // back in the parent: add the number of vertices in the sub-DFS-tree
+          frame_t& p(stack.back());
+          p.subtree_size += subtree_size;
+          // after recursion, we know whether e is a bridge or not
+          if(!p.e->is_bridge) p.smallest_num = min(p.smallest_num, number);
+          ++p.e;
+        }
+      }
+    }
+    // in any case, return the number of vertices in the DFS tree of root
     return subtree_size;
   }
 
@@ -527,64 +1293,127 @@ namespace cr{
 // Tarjan Bridgefinder follows, lucky for us, C++ doesn't allow declaring functions inside functions so I cannot make it more readable...
 // theory largely from wikipedia
 // I extended it a bit to also return the size of the component at the head of each bridge (when deleting the bridge)
-
-  // phase 1: give every vertex a number in preorder and compute the tarjan infos
-  void tarjan_dfs(vertex_p v, vertex_p parent, uint &current_number, edgelist &bridgelist, list<uint>& comp_sizes){
-    // initialize tarjan infos
-    v->tarjan_infos.number = current_number;
-    v->tarjan_infos.L = current_number;
-    v->tarjan_infos.H = current_number;
-    v->tarjan_infos.ND = 1;
-
+// the DFS uses an explicit stack instead of recursion, since long paths would overflow the call stack
+
+  // give a vertex its number in preorder and initialize its tarjan infos
+  inline void tarjan_enter(tarjan_info_t& infos, uint &current_number){
+    infos.number = current_number;
+    infos.L = current_number;
+    infos.H = current_number;
+    infos.ND = 1;
     // next vertex gets next number
     current_number++;
-    
-    // go through adjacent vertices and dive whenever we haven't met it before
-    for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); e++){
-      if(e->head->tarjan_infos.number == 0){ // head is uninitialized
-        tarjan_dfs(e->head, v, current_number, bridgelist, comp_sizes);
-
-        const tarjan_info_t& child_infos(e->head->tarjan_infos);
-        // update tarjan_infos in v with "tree edges"
-        v->tarjan_infos.ND += child_infos.ND;
-        v->tarjan_infos.L = min(v->tarjan_infos.L, child_infos.L);
-        v->tarjan_infos.H = max(v->tarjan_infos.H, child_infos.H);
+  }
+
+  // phase 1: give every vertex a number in preorder and compute the tarjan infos
+  // if known_bridges is set, then edges marked as bridges are not followed and the new bridges are marked right away
+  // (this lets us search inside a 2-edge-connected component), otherwise the bridge flags are ignored and left alone
+  void tarjan_dfs(vertex_p root, vertex_p root_parent, uint &current_number, edgelist &bridgelist, list<uint>& comp_sizes, const bool known_bridges){
+    // the vertices on the DFS path, their parents and the arc that they're currently looking at
+    struct frame_t{
+      vertex_p v, parent;
+      edge_p e;
+    };
+    vector<frame_t> stack;
+    graph& g(*root.get_graph());
+
+    tarjan_enter(g.tarjan_infos(root), current_number);
+    stack.push_back(frame_t{root, root_parent, root->adj_list.begin()});
+    while(!stack.empty()){
+      frame_t& f(stack.back());
+      // go through adjacent vertices and dive whenever we haven't met it before
+      if(f.e != f.v->adj_list.end()){
+        const edge_p e(f.e);
+        if(!known_bridges || !e->is_bridge){
+          if(g.tarjan_infos(e->head).number == 0){ // head is uninitialized
+            // dive, we'll continue with e once the head is done
+            tarjan_enter(g.tarjan_infos(e->head), current_number);
+            const vertex_p v(f.v);
+            stack.push_back(frame_t{e->head, v, e->head->adj_list.begin()});
+            continue;
+          } else if(e->head != f.parent){
+            const tarjan_info_t& child_infos(g.tarjan_infos(e->head));
+            // update tarjan_infos in v with "non-tree edges"
+            g.tarjan_infos(f.v).L = min(g.tarjan_infos(f.v).L, child_infos.L);
+            g.tarjan_infos(f.v).H = max(g.tarjan_infos(f.v).H, child_infos.H);
+          }
+        }
+        ++f.e;
+      } else {
+        // we're done with v, go back to its parent
+        stack.pop_back();
+        if(stack.empty()) break;
+        frame_t& p(stack.back());
+        const edge_p e(p.e);
+        const tarjan_info_t& child_infos(g.tarjan_infos(e->head));
+        // update tarjan_infos in the parent with "tree edges"
+        g.tarjan_infos(p.v).ND += child_infos.ND;
+        g.tarjan_infos(p.v).L = min(g.tarjan_infos(p.v).L, child_infos.L);
+        g.tarjan_infos(p.v).H = max(g.tarjan_infos(p.v).H, child_infos.H);
         // check whether e is a bridge and mark, don't forget to mark the other direction as well
         if((child_infos.L == child_infos.number) && (child_infos.H < child_infos.number + child_infos.ND)) {
-          DEBUG1(cout << "found bridge: " << e<< " splitting away "<< e->head->tarjan_infos.ND <<" vertices"<< endl);
-          e->mark_bridge();
+          DEBUG1(cout << "found bridge: " << e<< " splitting away "<< g.tarjan_infos(e->head).ND <<" vertices"<< endl);
+          if(known_bridges) e->mark_bridge();
           bridgelist.push_back(e);
           comp_sizes.push_back(child_infos.ND);
         }
-      } else if(e->head != parent){
-        const tarjan_info_t& child_infos(e->head->tarjan_infos);
-        // update tarjan_infos in v with "non-tree edges"
-        v->tarjan_infos.L = min(v->tarjan_infos.L, child_infos.L);
-        v->tarjan_infos.H = max(v->tarjan_infos.H, child_infos.H);
-      } // end if
-    } // end for
-//    DEBUG1(cout << "tarjan infos for " << *v << ": num = " << v->tarjan_infos.number << " L = " << v->tarjan_infos.L << " H = " << v->tarjan_infos.H << " ND = " << v->tarjan_infos.ND << endl);
+        ++p.e;
+      }
+    }
+//    DEBUG1(cout << "tarjan infos for " << *v << ": num = " << g.tarjan_infos(v).number << " L = " << g.tarjan_infos(v).L << " H = " << g.tarjan_infos(v).H << " ND = " << g.tarjan_infos(v).ND << endl);
+  }
+
+  void graph::prepare_tarjan_infos(const bool reset){
+    if(reset)
+      tarjan_store.assign(vertex_store.size(), tarjan_info_t());
+    else if(tarjan_store.size() < vertex_store.size())
+      tarjan_store.resize(vertex_store.size());
   }
 
   // return all bridges in a graph
+  // the bridges are found without looking at the old bridge flags, so only the edges and vertices whose flags or
+  // incident_bridges actually change have to be touched (and saved in the modification trail) afterwards
   void graph::compute_bridges(edgelist& bridgelist, list<uint>& split_off_sizes){
     cc_number = 0;
-    if(num_edges() == 0) {bridges_marked = true; return;}
+    invalidate_bridges();
 
-    // prepare tarjan_infos and incident_bridges
-    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) {
-      v->incident_bridges = 0;
-      v->tarjan_infos = tarjan_info_t();
-      v->tarjan_infos.number = 0;
-    }
+    prepare_tarjan_infos(true);
+    vector<vertex_p> all_vertices;
+    all_vertices.reserve(vertices.size());
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) all_vertices.push_back(v);
 
     uint number = 1;
     // compute the connected components
     for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) // need to iterate in case there are multiple components
-      if(v->tarjan_infos.number == 0){
+      if(tarjan_infos(v).number == 0){
         cc_number++;
-        tarjan_dfs(v, vertices.end(), number, bridgelist, split_off_sizes);
+        tarjan_dfs(v, vertices.end(), number, bridgelist, split_off_sizes, false);
+      }
+
+    // bring the bridge flags and the incident bridges up to date, replacing the incident bridges in one go if they changed
+    vector<bool> is_bridge(arc_store.size() / 2, false);
+    for(const edge_p& e : bridgelist) is_bridge[e.index() / 2] = true;
+    vector<uint> incident(hot_fields[IncidentBridges]);
+    bool changed(false);
+    for(const vertex_p& v : all_vertices){
+      uint incident_bridges = 0;
+      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e){
+        const bool b(is_bridge[e.index() / 2]);
+        if(e->is_bridge != b){
+          save_arc_flags(*e);
+          e->is_bridge = b;
+          e->get_reversed()->is_bridge = b;
+          classify_arc(e.index());
+          classify_arc(e.index() ^ 1);
+        }
+        incident_bridges += b;
+      }
+      if(incident[v.idx] != incident_bridges){
+        incident[v.idx] = incident_bridges;
+        changed = true;
       }
+    }
+    if(changed) replace_field(IncidentBridges, incident);
 //    uint dfs_id = get_dfs_id();
 //    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) // need to iterate in case there are multiple components
 //      if(v->dfs_id != dfs_id){
@@ -593,14 +1422,86 @@ namespace cr{
 //      }
 
     DEBUG2(cout << "found "<<bridgelist.size()<<" bridges"<<endl);
+    label_two_eccs(all_vertices);
     bridges_marked = true;
   }
 
+  void graph::repair_bridges(){
+    DEBUG2(cout << "repairing bridges around "<<bridge_repairs.size()<<" vertices in "<<dirty_two_eccs.size()<<" 2-edge-connected components"<<endl);
+    // the dirty 2-edge-connected components may have fallen apart into pieces, find those pieces
+    // note that two pieces of the same component cannot be connected via some other component,
+    // since otherwise, they would still be 2-edge-connected
+    const uint dfs_id(get_dfs_id());
+    prepare_tarjan_infos(false);
+    vector<vertex_p> pieces;
+    vector<uint> piece_start;
+    for(const uint i : bridge_repairs) if(present[i]){
+      const vertex_p v(this, i);
+      if(v->dfs_id == dfs_id) continue;
+      piece_start.push_back(pieces.size());
+      v->dfs_id = dfs_id;
+      pieces.push_back(v);
+      for(uint j = piece_start.back(); j < pieces.size(); ++j){
+        const vertex_p u(pieces[j]);
+        tarjan_infos(u) = tarjan_info_t();
+        for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+          if(!e->is_bridge && (e->head->dfs_id != dfs_id)){
+            e->head->dfs_id = dfs_id;
+            pieces.push_back(e->head);
+          }
+      }
+    }
+    // each dirty component that fell into p pieces adds p - 1 components to the graph (-1 if it disappeared completely)
+    cc_number += piece_start.size();
+    cc_number -= dirty_two_eccs.size();
+    // find the new bridges in each piece
+    edgelist bridgelist;
+    list<uint> split_off_sizes;
+    for(const uint start : piece_start){
+      uint number = 1;
+      tarjan_dfs(pieces[start], vertices.end(), number, bridgelist, split_off_sizes, true);
+    }
+    label_two_eccs(pieces);
+    bridge_repairs.clear();
+    dirty_two_eccs.clear();
+  }
+
+  // each component keeps the old label of its first vertex unless another component got it already, so the vertices of
+  // components that did not change keep their labels and don't have to be saved in the modification trail
+  void graph::label_two_eccs(const vector<vertex_p>& vs){
+    const uint dfs_id(get_dfs_id());
+    vector<vertex_p> todo;
+    unordered_set<uint> taken;
+    for(const vertex_p& v : vs) if(v->dfs_id != dfs_id){
+      const uint old_label(hot_fields[TwoEcc][v.idx]);
+      const uint label(((old_label != no_index) && taken.insert(old_label).second) ? old_label : next_two_ecc++);
+      v->dfs_id = dfs_id;
+      todo.push_back(v);
+      while(!todo.empty()){
+        const vertex_p u(todo.back());
+        todo.pop_back();
+        set_field(TwoEcc, u.idx, label);
+        for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+          if(!e->is_bridge && (e->head->dfs_id != dfs_id)){
+            e->head->dfs_id = dfs_id;
+            todo.push_back(e->head);
+          }
+      }
+    }
+  }
+
+  void graph::invalidate_bridges(){
+    bridges_marked = false;
+    bridge_repairs.clear();
+    dirty_two_eccs.clear();
+  }
+
   edgelist graph::get_bridges(){
+    mark_bridges();
     edgelist bridges;
-    list<uint> split_off_sizes;
-    // compute both bridges and split_off_sizes, but ignore the latter
-    compute_bridges(bridges, split_off_sizes);
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v)
+      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
+        if(e->is_bridge && !(e.index() & 1)) bridges.push_back(e);
     return bridges;
   }
 
@@ -621,7 +1522,11 @@ namespace cr{
 
   // mark all bridges in a graph (also update cyclic core!), UNLESS the bridges are still marked from a previous run
   void graph::mark_bridges(){
-    if(!bridges_marked) get_bridges();
+    if(!bridges_marked){
+      edgelist bridges;
+      list<uint> split_off_sizes;
+      compute_bridges(bridges, split_off_sizes);
+    } else if(!bridge_repairs.empty()) repair_bridges();
   }
 
   edgelist graph::get_Bbridges(){
@@ -650,15 +1555,17 @@ namespace cr{
   }
 
   // copy the connected component containing v from *this to gto
-  void graph::copy_component(const vertex_p& v, graph& gto, unordered_map<uint, vertex_p>* id_to_vertex){
+  void graph::copy_component(const vertex_p& v, graph& gto, vector<vertex_p>* id_to_vertex){
     const uint dfs_id(get_dfs_id());
     list<vertex_p> to_consider;
 
     // prepare to_consider
     to_consider.push_back(v);
 
-    const bool destroy_map(id_to_vertex == NULL);
-    if(destroy_map) id_to_vertex = new unordered_map<uint, vertex_p>();
+    vector<vertex_p> local_map;
+    if(id_to_vertex == NULL) id_to_vertex = &local_map;
+    id_to_vertex->assign(current_id, vertex_p());
+    gto.input = input;
 
     // and do the BFS
     while(!to_consider.empty()){
@@ -669,18 +1576,116 @@ namespace cr{
         // copy v into comp, saving the map from v's ID to v's copy
         DEBUG2(cout << "copying "<<*u<<"(id: "<<u->id<<")"<<endl;);
         vertex_p my_new_vertex(gto.add_vertex_fast(u->name));
-        id_to_vertex->insert(make_pair(u->id, my_new_vertex));
+        (*id_to_vertex)[u->id] = my_new_vertex;
         u->dfs_id = dfs_id;
   
         // add the neighbors of u to be considered
-        for(edge e : u->adj_list)
-          if(e.head->dfs_id != dfs_id)
-            to_consider.push_back(e.head);
+        for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+          if(e->head->dfs_id != dfs_id)
+            to_consider.push_back(e->head);
           else // or add the edge if they already have been considered
-            gto.add_edge_fast(my_new_vertex, id_to_vertex->at(e.head->id));
+            gto.add_edge_fast(my_new_vertex, (*id_to_vertex)[e->head->id], e->input_id);
       }
     }
-    if(destroy_map) delete id_to_vertex;
+  }
+
+  // move the connected component containing v from *this to gto
+  // the vertices are created in BFS order and the edges are added in the same order as in copy_component
+  vertex_p graph::move_component(const vertex_p& v, graph& gto){
+    DEBUG1(cout << "moving component of " << *v << endl);
+    // no repairs may refer to the vertices we're about to remove
+    if(!bridge_repairs.empty()) repair_bridges();
+
+    const uint dfs_id(get_dfs_id());
+    vector<vertex_p> order;
+    uint arcs = 0;
+    // collect the component in BFS order
+    order.push_back(v);
+    v->dfs_id = dfs_id;
+    for(uint i = 0; i < order.size(); ++i){
+      const vertex_p u(order[i]);
+      arcs += u->degree();
+      for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+        if(e->head->dfs_id != dfs_id){
+          e->head->dfs_id = dfs_id;
+          order.push_back(e->head);
+        }
+    }
+    const uint first(gto.current_id);
+    move_vertices(order, arcs, gto, false);
+    if(bridges_marked) cc_number--;
+    return vertex_p(&gto, first);
+  }
+
+  // we use reverse Cuthill-McKee order: in each component, start a BFS at a vertex of minimum degree, visiting the
+  // neighbors of each vertex by increasing degree, then reverse the whole order
+  void graph::move_all(graph& gto){
+    DEBUG1(cout << "moving all "<<vertices.size()<<" vertices into fresh storage" << endl);
+    if(!bridge_repairs.empty()) repair_bridges();
+
+    const auto by_degree([](const vertex_p& x, const vertex_p& y){ return x->degree() < y->degree(); });
+    vector<vertex_p> starts;
+    starts.reserve(vertices.size());
+    for(vertex_p v = vertices.begin(); v != vertices.end(); ++v) starts.push_back(v);
+    stable_sort(starts.begin(), starts.end(), by_degree);
+
+    const uint dfs_id(get_dfs_id());
+    vector<vertex_p> order;
+    order.reserve(vertices.size());
+    uint arcs = 0;
+    for(const vertex_p& start : starts) if(start->dfs_id != dfs_id){
+      start->dfs_id = dfs_id;
+      order.push_back(start);
+      for(uint i = order.size() - 1; i < order.size(); ++i){
+        const vertex_p u(order[i]);
+        arcs += u->degree();
+        const uint discovered(order.size());
+        for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+          if(e->head->dfs_id != dfs_id){
+            e->head->dfs_id = dfs_id;
+            order.push_back(e->head);
+          }
+        stable_sort(order.begin() + discovered, order.end(), by_degree);
+      }
+    }
+    reverse(order.begin(), order.end());
+    move_vertices(order, arcs, gto, true);
+    if(bridges_marked) cc_number = 0;
+  }
+
+  // instead of a map, we remember the index of the new vertex in the (scratch) tarjan number of the old one
+  // the vertices are then detached from *this by just marking them deleted: since none of their neighbors
+  // stays in *this, their adjacencies may stay as they are, which also makes this cheap to undo
+  void graph::move_vertices(const vector<vertex_p>& order, const uint arcs, graph& gto, const bool keep_flags){
+    prepare_tarjan_infos(false);
+    for(uint i = 0; i < order.size(); ++i) tarjan_infos(order[i]).number = i;
+
+    // build the vertices in gto, reserving all the space at once
+    gto.input = input;
+    const uint first(gto.current_id);
+    gto.vertex_store.reserve(first + order.size());
+    gto.arc_store.reserve(gto.arc_store.size() + arcs);
+    gto.present.reserve(first + order.size());
+    for(uint i = 0; i < order.size(); ++i){
+      const vertex_p u(order[i]);
+      const vertex_p new_u(gto.add_vertex_fast(u->name));
+      if(keep_flags) new_u->prot = u->prot;
+      for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
+        if(tarjan_infos(e->head).number < i){
+          const edge_p f(gto.add_edge_fast(new_u, vertex_p(&gto, first + tarjan_infos(e->head).number), e->input_id));
+          if(keep_flags && e->is_permanent) f->mark_permanent();
+        }
+    }
+
+    // and detach them from *this
+    for(const vertex_p& u : order){
+      index_vertex(*u, false);
+      present[u.idx] = false;
+      if(logging()) log(DeleteVertex, u.idx);
+    }
+    vertices.count -= order.size();
+    edgenum -= arcs / 2;
+    if(arcs) subtrees_marked = false;
   }
 
   // return the size of the connected component of v
@@ -712,31 +1717,32 @@ namespace cr{
   }
 
   // split a component off of a graph
-  void split_off_component(graph& g, graph& comp, unordered_map<uint, vertex_p>* id_to_vertex){
+  void split_off_component(graph& g, graph& comp){
     if(g.cc_number < 2) return;
     if(g.vertices.empty()) return;
 
-    g.copy_component(g.vertices.begin(), comp, id_to_vertex);
-    g.delete_component(g.vertices.begin());
+    g.move_component(g.vertices.begin(), comp);
   }
 
 
-  void graph::add_disjointly(const graph& Gfrom, unordered_map<uint, vertex_p>* id_to_vertex){
+  // the ids of Gfrom are dense, so we translate them with a vector instead of a map
+  void graph::add_disjointly(const graph& Gfrom, vector<vertex_p>* id_to_vertex){
+    vector<vertex_p> local_map;
+    if(id_to_vertex == NULL) id_to_vertex = &local_map;
+    id_to_vertex->assign(Gfrom.current_id, vertex_p());
     if(Gfrom.vertices.empty()) return;
-    const bool destroy_map(id_to_vertex == NULL);
-    if(destroy_map) id_to_vertex = new unordered_map<uint, vertex_p>();
+    vertex_store.reserve(current_id + Gfrom.vertices.size());
+    arc_store.reserve(arc_store.size() + 2 * Gfrom.edgenum);
+    present.reserve(current_id + Gfrom.vertices.size());
     // copy vertices
     for(vertex_pc x = Gfrom.vertices.begin(); x != Gfrom.vertices.end(); ++x){
       vertex_p y(add_vertex_fast(x->name));
       y->prot = x->prot;
       (*id_to_vertex)[x->id] = y;
-      // copy edges involving v
-      for(edge_pc e = x->adj_list.begin(); e != x->adj_list.end(); ++e){
-        const unordered_map<uint, vertex_p>::const_iterator i(id_to_vertex->find(e->head->id));
-        if(i != id_to_vertex->end()) add_edge_fast(i->second, y, e);
-      }
+      // copy edges to the vertices we copied before (which are exactly the neighbors of smaller id)
+      for(edge_pc e = x->adj_list.begin(); e != x->adj_list.end(); ++e)
+        if(e->head->id < x->id) add_edge_fast((*id_to_vertex)[e->head->id], y, e);
     }
-    if(destroy_map) delete id_to_vertex;
   }
 
 
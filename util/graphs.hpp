@@ -2,75 +2,236 @@
 #define GRAPHS_HPP
 
 #include <cstdlib>
+#include <climits>
 #include <set>
 #include <list>
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <memory>
 
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include <stdint.h>
+
 #include "defs.hpp"
+#include "paged_array.hpp"
 
 
 using namespace std;
 
 
- 
+
 namespace cr {
 
-  // my graph will be a list of adjacency lists
-  //  for each vertex, its adjacency list contains pointers to an edge
-  //  edges contain pointers to both its endpoints _and_ to the appropriate positions in the respective adjacency lists
+  // my graph keeps all vertices and all edges in contiguous storage and addresses them by their index
+  //  each edge {u,v} is stored as two arcs u->v and v->u with indices 2i and 2i+1, so the reversal of arc a is arc a^1
+  //  for each vertex, its adjacency list is an array of indices of arcs leaving it
+  //  each arc knows its head and its position in the adjacency list of its tail
+  //  vertex_p and edge_p are handles (graph + index) that can be used like the list-iterators they replace
 
   class vertex;
   class edge;
   class graph;
   class instance;
 
+  // the index of "nothing", used for end()-handles
+  const uint no_index = UINT_MAX;
+  // vertices whose degree reaches this get an index of their neighbors (see vertex::nbr_index)
+  const uint nbr_index_threshold = 32;
 
-  typedef list<vertex>::iterator vertex_p;
-  typedef list<vertex>::const_iterator vertex_pc;
-  typedef list<edge>::iterator edge_p;
-  typedef list<edge>::const_iterator edge_pc;
+  // handle to a vertex of a graph; incrementing the handle moves to the next vertex of the graph
+  template<class G, class V>
+  class vertex_handle {
+    template<class, class> friend class vertex_handle;
+    friend class graph;
+  protected:
+    G* g;
+    uint idx;
+  public:
+    vertex_handle():g(NULL),idx(no_index){}
+    vertex_handle(G* const _g, const uint _idx):g(_g),idx(_idx){}
+    // allow converting handles to const handles
+    template<class G2, class V2>
+    vertex_handle(const vertex_handle<G2, V2>& v):g(v.g),idx(v.idx){}
+
+    inline uint index() const {return idx;}
+    inline G* get_graph() const {return g;}
+
+    inline V& operator*() const;
+    inline V* operator->() const;
+
+    inline vertex_handle& operator++();
+    inline vertex_handle operator++(int){
+      vertex_handle tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+
+    template<class G2, class V2>
+    inline bool operator==(const vertex_handle<G2, V2>& v) const {return (idx == v.idx) && (g == v.g);}
+    template<class G2, class V2>
+    inline bool operator!=(const vertex_handle<G2, V2>& v) const {return !(*this == v);}
+  };
+
+  // handle to an arc of a graph; incrementing the handle moves to the next arc in the adjacency list of its tail
+  template<class G, class E>
+  class edge_handle {
+    template<class, class> friend class edge_handle;
+    friend class graph;
+  protected:
+    G* g;
+    uint idx;
+  public:
+    edge_handle():g(NULL),idx(no_index){}
+    edge_handle(G* const _g, const uint _idx):g(_g),idx(_idx){}
+    // allow converting handles to const handles
+    template<class G2, class E2>
+    edge_handle(const edge_handle<G2, E2>& e):g(e.g),idx(e.idx){}
+
+    inline uint index() const {return idx;}
+    inline G* get_graph() const {return g;}
+
+    inline E& operator*() const;
+    inline E* operator->() const;
+
+    inline edge_handle& operator++();
+    inline edge_handle& operator--();
+    inline edge_handle operator++(int){
+      edge_handle tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    inline edge_handle operator--(int){
+      edge_handle tmp(*this);
+      --(*this);
+      return tmp;
+    }
+
+    template<class G2, class E2>
+    inline bool operator==(const edge_handle<G2, E2>& e) const {return (idx == e.idx) && (g == e.g);}
+    template<class G2, class E2>
+    inline bool operator!=(const edge_handle<G2, E2>& e) const {return !(*this == e);}
+  };
+
+  typedef vertex_handle<graph, vertex> vertex_p;
+  typedef vertex_handle<const graph, const vertex> vertex_pc;
+  typedef edge_handle<graph, edge> edge_p;
+  typedef edge_handle<const graph, const edge> edge_pc;
 
   typedef list<vertex_p> vertexlist;
   typedef list<edge_p> edgelist;
-  
+
   typedef vertexlist::iterator vertex_pp;
   typedef vertexlist::const_iterator vertex_ppc;
   typedef edgelist::iterator edge_pp;
   typedef edgelist::const_iterator edge_ppc;
 
-  // hash an edge using the IDs of its vertices
-  class hash_edge {
-    public:
-      uint operator()(const edge_p& e) const;
-  };
-  typedef unordered_map<edge_p, uint, hash_edge> weighted_edges;
-  typedef pair<edge_p, uint> weighted_edge;
+  // the Zobrist keys of the graph fingerprint (see graph::fingerprint()) are mixes of the vertex ids, so they need no
+  // table and a graph gets the same fingerprint in every run; the mixer is the finalizer of splitmix64
+  inline uint64_t mix64(uint64_t x){
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+  // no vertex has id no_index, so vertex keys and edge keys come from disjoint inputs
+  inline uint64_t vertex_key(const uint id) {return mix64(((uint64_t)id << 32) | no_index);}
+  inline uint64_t edge_key(const uint u, const uint w) {return (u < w) ? mix64(((uint64_t)u << 32) | w) : mix64(((uint64_t)w << 32) | u);}
 
-  // hash a graph using the ids of its vertices and their degrees
+  // hash a graph by its fingerprint
   class hash_graph {
     public:
-      uint operator()(const graph& e) const;
+      size_t operator()(const graph& g) const;
+  };
+
+  // what we remember about the input graph: the names of its vertices and the endpoints of its edges
+  // names are interned here once when the graph is read, vertices and solutions only refer to them by index
+  // all graphs derived from the input (copies, components, ...) share the same input_info_t
+  // if the input numbers its vertices (as PACE, DIMACS and METIS do), then we keep no names and name i is the number i+1
+  struct input_info_t{
+    vector<string> names;
+    vector<pair<uint, uint> > edges;
+    bool numbered;
+
+    input_info_t():names(),edges(),numbered(false){}
+
+    inline string name(const uint i) const {return numbered ? to_string(i + 1) : names[i];}
   };
 
-    // can't take a list of edges here because some reduction rules replace parts without knowing the exact edge to delete; they will just register "some edge incident to v"
-  typedef list<string> solution_t;
+  // a solution is a list of input edges (indices into input_info_t::edges)
+  // some reduction rules replace parts without knowing the exact edge to delete; they register no_index ("some edge") instead
+  typedef list<uint> solution_t;
 
   struct tarjan_info_t{
     uint number, L, H, ND;
 
     tarjan_info_t():number(0),L(0),H(0),ND(0){}
   };
+  // a list of arcs that keeps up to two arcs in place and only allocates memory if it grows beyond that
+  // (most vertices have very few pendants of each kind, and the TRRs fill and clear these lists all the time)
+  // the arcs are stored back to front, so push_front() and pop_front(), which is what the TRRs use, are cheap
+  class pendant_list {
+    static const uint local_size = 2;
+    graph* g;
+    uint count;
+    uint capacity;
+    union storage_t {
+      uint local[local_size];
+      uint* heap;
+    } store;
+
+    inline uint* arcs() {return capacity > local_size ? store.heap : store.local;}
+    inline const uint* arcs() const {return capacity > local_size ? store.heap : store.local;}
+    // double the capacity
+    void grow();
+  public:
+    // iterates from front to back, giving out handles to the arcs
+    class const_iterator {
+      graph* g;
+      const uint* p;
+    public:
+      const_iterator(graph* const _g, const uint* const _p):g(_g),p(_p){}
+      inline edge_p operator*() const {return edge_p(g, *(p - 1));}
+      inline const_iterator& operator++() {--p; return *this;}
+      inline bool operator==(const const_iterator& i) const {return p == i.p;}
+      inline bool operator!=(const const_iterator& i) const {return p != i.p;}
+    };
+
+    explicit pendant_list(graph* const _g):g(_g),count(0),capacity(local_size),store(){}
+    pendant_list(const pendant_list& l);
+    pendant_list& operator=(const pendant_list& l);
+    ~pendant_list(){ if(capacity > local_size) delete[] store.heap; }
+
+    inline uint size() const {return count;}
+    inline bool empty() const {return count == 0;}
+    // clearing keeps the memory, so filling the list again doesn't allocate
+    inline void clear() {count = 0;}
+
+    inline edge_p front() const {return edge_p(g, arcs()[count - 1]);}
+    inline void push_front(const edge_p& e){
+      if(count == capacity) grow();
+      arcs()[count++] = e.index();
+    }
+    inline void pop_front() {--count;}
+    // remove all but the first n arcs
+    void truncate(const uint n);
+    void push_back(const edge_p& e);
+    void swap(pendant_list& l);
+
+    inline const_iterator begin() const {return const_iterator(g, arcs() + count);}
+    inline const_iterator end() const {return const_iterator(g, arcs());}
+  };
+
   struct trr_info_t{
-    edgelist leaves,ptwos,ygraphs,tclaws;
+    pendant_list leaves,ptwos,ygraphs,tclaws;
     // edge FROM child TO parent!
 
+    explicit trr_info_t(graph* const g):leaves(g),ptwos(g),ygraphs(g),tclaws(g){}
+
     inline void clear(){leaves.clear();ptwos.clear();ygraphs.clear();tclaws.clear();}
+    inline void swap(trr_info_t& t){leaves.swap(t.leaves);ptwos.swap(t.ptwos);ygraphs.swap(t.ygraphs);tclaws.swap(t.tclaws);}
     inline uint count() const{
       return leaves.size() + ptwos.size() + ygraphs.size() + tclaws.size();
     }
@@ -79,6 +240,37 @@ namespace cr {
     }
 
   };
+
+  // the adjacency list of a vertex: the indices of all arcs leaving it
+  class adjacency {
+    friend class graph;
+    template<class, class> friend class edge_handle;
+    friend class vertex;
+
+    graph* g;
+    vector<uint> arcs;
+    // the same arcs, partitioned into three segments (in no particular order within a segment):
+    //  [0, pendant_end):           bridges to leaves (pendant arcs)
+    //  [pendant_end, core_begin):  bridges to non-leaves
+    //  [core_begin, size()):       non-bridges (these lead to the cyclic core)
+    // the graph moves arcs between the segments whenever their is_bridge flag or the degree of their head changes,
+    // so the queries for cyclic (core) neighbors don't have to look at the (possibly many) pendant arcs
+    vector<uint> segments;
+    uint pendant_end, core_begin;
+
+    // turn the result of a search in the segments into an edge_p, setting success if given
+    edge_p found(const uint best, bool *success);
+  public:
+    adjacency(graph* const _g):g(_g),arcs(),segments(),pendant_end(0),core_begin(0){}
+
+    inline uint size() const {return arcs.size();}
+    inline bool empty() const {return arcs.empty();}
+
+    inline edge_p begin() {return edge_p(g, arcs.empty() ? no_index : arcs.front());}
+    inline edge_p end() {return edge_p(g, no_index);}
+    inline edge_pc begin() const {return edge_pc(g, arcs.empty() ? no_index : arcs.front());}
+    inline edge_pc end() const {return edge_pc(g, no_index);}
+  };
 };
 
 
@@ -88,31 +280,38 @@ namespace cr{
     friend class edge;
     friend class graph;
   public:
+    // the fields that every scan over the vertices looks at come first, so they share a cache line
     uint id;
 
-    // vertices can be protected from removal, we need this for the Bbridge_rule
-    bool prot;
-
     // used to detect whether he was visited in the current DFS
     // since c++ stores bools in uint's anyways, we might as well use this to perform less vertex-updates using "dfs id's":
     // each time a dfs is to be perfomed, get a new id from the graph and use this id to check whether we already visited the vertex
     uint dfs_id;
 
-    // number of neighbors that are not in the cyclic core
-    uint incident_bridges;
-    string name;
+    // vertices can be protected from removal, we need this for the Bbridge_rule
+    bool prot;
 
     // the adjacency list of the vertex
-    list<edge> adj_list;
+    adjacency adj_list;
 
     // some infos related to TRRs
     trr_info_t trr_infos;
 
-    // finally, tarjan infos
-    tarjan_info_t tarjan_infos;
+    // index of our name in the names of the input, no_index if we don't have one
+    // vertices that are created by the reduction rules inherit the name of the vertex they represent
+    uint name;
+
+    // vertices of degree at least nbr_index_threshold map the ids of their neighbors to the arcs leading there,
+    // so find_edge() doesn't have to scan their adjacency list (maintained by the graph, NULL for small degrees)
+    unique_ptr<unordered_map<uint, uint> > nbr_index;
+
+    // NOTE: the tarjan infos are scratch space of the graph's DFSs and live in graph::tarjan_store, and the number of
+    // incident bridges, the label of our 2-edge-connected component and the arc to our parent live in graph::hot_fields
   private:
-    bool parent_valid; // DAMN YOU C++ for not having a "NULL"-iterator to represent "uninitialized"
-    edge_p parent;
+    // the checkpoint for which our state has last been saved in the modification trail (see graph::checkpoint())
+    uint saved_at;
+    // the number of arcs leading to non-leaves (maintained by the graph, see graph::index_degree())
+    uint non_leaves;
 
   public:
 
@@ -120,36 +319,21 @@ namespace cr{
      * constructors
      ****************/
 
-    vertex(const uint new_id):id(new_id),prot(false),dfs_id(0),incident_bridges(0),parent_valid(false){}
-    vertex(const vertex& v);
-    
-    // empty destructor for testing purposes, TODO: remove
-    ~vertex(){};
+    vertex(graph* const g, const uint new_id):id(new_id),dfs_id(0),prot(false),adj_list(g),trr_infos(g),name(no_index),nbr_index(),saved_at(0),non_leaves(0){}
+    // vertices live in the storage of their graph and are never copied
+    vertex(const vertex& v) = delete;
+    vertex& operator=(const vertex& v) = delete;
 
     inline uint subtree_NH() const {return trr_infos.count();}
     inline bool operator<(const vertex& v) const {return id < v.id;}
     inline bool operator==(const vertex& v) const {return id == v.id;}
-    inline operator string() const{return name;}
+    inline operator string() const;
 
     // This is preferred to is_on_cyclic_core, because if we only have a tree, the root doesn't have a parent!
     inline uint degree() const {
       return adj_list.size();
     }
 
-    void init(const uint _dfs_id, const uint _incident_bridges, const string& _name){
-      dfs_id = _dfs_id;
-      incident_bridges = _incident_bridges;
-      name = _name;
-      parent_valid = false;
-    }
-    void init_from(const vertex_p& v){
-      init(v->dfs_id, v->incident_bridges, v->name);
-    }
-    vertex& operator=(const vertex& v) {
-      init(v.dfs_id, v.incident_bridges, v.name);
-      return *this;
-    }
-
     inline uint cyc_core_degree() const{
       const uint d = degree() - subtree_NH();
       if(d == 1) return 0; else return d;
@@ -164,37 +348,36 @@ namespace cr{
     edgelist get_cyclic_core_neighbors();
 
     // TODO: the next functions are very similar, maybe unify them with a test functional
-    // TODO: also all 4 functions are suboptimal, maybe maintain a list of cyclic neighbors!
+    // the next 4 functions only look at the non-pendant segments of the adjacency, since leaves are never on the cyclic core
 
     // returns edge to the first cyclic core neighbor of v (*success = true) or any vertex (*success = false) if none exists
     edge_p first_cyclic_core_neighbor_except(const vertex_p& except, bool *success = NULL);
     edge_p first_cyclic_core_neighbor(bool *success = NULL);
-    
+
     // returns edge to the first non bridge neighbor of v (*success = true) or any vertex (*success = false) if there is none
     edge_p first_non_bridge_neighbor_except(const vertex_p& except, bool *success = NULL);
     edge_p first_non_bridge_neighbor(bool *success = NULL);
 
+    // save prot, name and trr_infos in the modification trail of the graph;
+    // call this before modifying any of them, so rolling back to a checkpoint restores them
+    inline void save_state();
+
     // get the parent of the vertex, assuming all subtrees have their parent set to us
-    inline bool has_parent() const {
-      return parent_valid;
-    }
-    inline void invalidate_parent() {
-      parent_valid = false;
-    }
-   
-    const edge_p& get_parent(bool *success = NULL);
-    
-    inline void set_parent(const edge_p& e){
-      parent_valid = true;
-      parent = e;
-    }
+    // (the graph logs changes of the parent itself)
+    inline bool has_parent() const;
+    inline void invalidate_parent();
+    edge_p get_parent(bool *success = NULL);
+    inline void set_parent(const edge_p& e);
 
 
 
-    uint nldeg() const;
+    // the number of neighbors that are not leaves
+    inline uint nldeg() const {return non_leaves;}
 
+    // the number of neighbors that are not in the cyclic core
+    inline uint incident_bridges() const;
     inline uint non_bridge_degree() const{
-      return degree() - incident_bridges;
+      return degree() - incident_bridges();
     }
 #define is_on_cycle() non_bridge_degree()
 //    inline bool is_on_cycle() const{
@@ -215,7 +398,7 @@ namespace cr{
     // decide whether v is a token separator
     bool is_separator() const;
     bool is_incident_to_Bbridge() const;
-    
+
     inline bool is_on_backbone() const{
       return !(trr_infos.leaves.empty() && trr_infos.ptwos.empty());
     }
@@ -224,72 +407,60 @@ namespace cr{
   class vertex_hasher{
   public:
     uint operator()(const vertex_p& x) const{
-      return x->id;
+      return x.index();
     }
   };
   typedef unordered_set<vertex_p, vertex_hasher> vertexset;
 
 
   class edge{
+    friend class adjacency;
     friend class vertex;
     friend class graph;
+    template<class, class> friend class edge_handle;
+
+    // index of this arc in the arc storage of the graph (the reversed arc has index ^ 1)
+    uint index;
+    // position of this arc in the adjacency list of its tail (no_index if the arc has been deleted)
+    uint pos;
+    // position of this arc in the segments of the adjacency of its tail (see adjacency::segments)
+    uint seg_pos;
   public:
     bool is_bridge;
     bool is_permanent;
+    // the input edge that this edge represents (see input_info_t), no_index if it doesn't represent any
+    uint input_id;
 
     const vertex_p head;
-    edge_p head_adj_pos;
 
 
     /******************
      * constructors
      ******************/
-    edge(const vertex_p& _head):is_bridge(false),is_permanent(false),head(_head){}
-    // empty destructor for testing purposes, TODO: remove
-    ~edge(){};
-        
-    edge_p& get_reversed(){return head_adj_pos;}
-    const edge_p& get_reversed() const{return head_adj_pos;}
+    edge(const vertex_p& _head, const uint _index, const uint _pos):index(_index),pos(_pos),seg_pos(no_index),is_bridge(false),is_permanent(false),input_id(no_index),head(_head){}
+    // edges live in the storage of their graph and are never copied
+    edge(const edge& e) = delete;
+    edge& operator=(const edge& e) = delete;
+
+    inline edge_p get_reversed() const {return edge_p(head.get_graph(), index ^ 1);}
 
     const vertex_p& get_head() const {return head;}
-    const vertex_p& get_tail() const {return get_reversed()->head;}
+    inline vertex_p get_tail() const {return get_reversed()->head;}
 
 
     bool operator==(const cr::edge& e) const{
-      return (head == e.head) && (head_adj_pos->head == e.head_adj_pos->head);
-    }
-    operator string() const {return (string)*(head_adj_pos->head) + "->" + (string)*(head);}
-    operator int() const {return head_adj_pos->head->id * 1000 + head->id;}
-
-    void init(const bool _is_permanent, const bool _is_bridge){
-      is_permanent = _is_permanent;
-      is_bridge = _is_bridge;
-      head_adj_pos->is_permanent = _is_permanent;
-      head_adj_pos->is_bridge = _is_bridge;
+      return (head == e.head) && (get_tail() == e.get_tail());
     }
-    void init_from(const edge_p& e){
-      init(e->is_permanent, e->is_bridge);
-    }
-    edge& operator=(const edge& e){
-      init(e.is_permanent, e.is_bridge);
-      return *this;
-    }
-
-    inline void mark_permanent(const bool mark = true) {
-      is_permanent = mark;
-      get_reversed()->is_permanent = mark;
-    }
-    inline void mark_bridge(const bool mark = true){
-      is_bridge = mark;
-      head->incident_bridges += (mark ? 1 : -1);
+    operator string() const {return (string)*get_tail() + "->" + (string)*head;}
 
-      get_reversed()->is_bridge = mark;
-      get_tail()->incident_bridges += (mark ? 1 : -1);
-    }
+    inline void mark_permanent(const bool mark = true);
+    inline void mark_bridge(const bool mark = true);
+    // let this edge represent the input edge id (no_index: no input edge at all)
+    inline void set_input_id(const uint id);
 
     inline bool is_Bbridge() const{
       if(!is_bridge) return false;
-      const vertex_p& v(get_tail());
+      const vertex_p v(get_tail());
       return (v->is_on_cyclic_core() && head->is_on_cyclic_core());
     }
 
@@ -302,7 +473,7 @@ namespace cr{
       if(!is_bridge) return false;
 
       // I am not a B bridge
-      const vertex_p& v(get_tail());
+      const vertex_p v(get_tail());
       if((v->is_on_cyclic_core() && head->is_on_cyclic_core())) return false; // == is_Bbridge(), but no overhead
 
       // I am relevant
@@ -314,20 +485,222 @@ namespace cr{
 
   };
 
+  // arc indices are unique, so they hash perfectly
   class edge_hasher{
   public:
     uint operator()(const edge_p& x) const{
-      const vertex_hasher h;
-      return h(x->head) + h(x->get_tail());
+      return x.index();
     }
   };
   typedef unordered_set<edge_p, edge_hasher> edgeset;
+  typedef unordered_map<edge_p, uint, edge_hasher> weighted_edges;
+  typedef pair<edge_p, uint> weighted_edge;
+
+  // the vertices of a graph, iterable like the list<vertex> it replaces
+  class vertex_list {
+    friend class graph;
+
+    graph* g;
+    uint count;
+  public:
+    vertex_list(graph* const _g):g(_g),count(0){}
+
+    inline uint size() const {return count;}
+    inline bool empty() const {return count == 0;}
+
+    inline vertex_p begin();
+    inline vertex_p end();
+    inline vertex_pc begin() const;
+    inline vertex_pc end() const;
+
+    inline vertex& front() {return *begin();}
+    inline const vertex& front() const {return *begin();}
+  };
 
   class graph {
+    template<class, class> friend class vertex_handle;
+    template<class, class> friend class edge_handle;
+    friend class vertex_list;
+    friend class adjacency;
+    friend class edge;
+    friend class vertex;
+    friend uint my_bridge_finder(const vertex_p& root, const vertex_p& root_parent, uint dfs_id, edgelist& bridgelist, list<uint>& comp_sizes);
   private:
+    // vertex and arc storage; indices are never reused, so handles to deleted vertices/arcs never point to new ones
+    paged_array<vertex> vertex_store;
+    paged_array<edge, 12> arc_store;
+    // present[i] is false iff vertex i has been deleted
+    vector<bool> present;
+
+    // the modification trail: while there is a checkpoint, all modifications are logged so they can be undone
+    enum trail_op {AddVertex, DeleteVertex, AddEdge, DeleteEdge, ArcFlags, VertexState, FieldValue, FieldArray};
+    struct trail_entry{
+      trail_op op;
+      uint index;
+      uint a, b;
+    };
+    // the state of a vertex that is not determined by the graph structure, saved by VertexState entries
+    struct vertex_state{
+      bool prot;
+      uint name;
+      trr_info_t trr_infos;
+
+      vertex_state(const vertex& v):prot(v.prot),name(v.name),trr_infos(v.trr_infos){}
+      // take the trr_infos of v instead of copying them, for callers that are about to clear them anyways
+      vertex_state(vertex& v, const bool take_trr_infos):prot(v.prot),name(v.name),trr_infos(v.adj_list.g){
+        if(take_trr_infos) trr_infos.swap(v.trr_infos); else trr_infos = v.trr_infos;
+      }
+    };
+    struct checkpoint_t{
+      uint trail_size;
+      uint stamp;
+      uint current_id;
+      uint edgenum;
+      uint cc_number;
+      bool bridges_marked;
+      bool subtrees_marked;
+    };
+    vector<trail_entry> trail;
+    vector<vertex_state> saved_states;
+    vector<checkpoint_t> checkpoints;
+    uint current_stamp;
+
+    inline bool logging() const {return !checkpoints.empty();}
+    inline void log(const trail_op op, const uint index, const uint a = 0, const uint b = 0){
+      trail_entry t = {op, index, a, b};
+      trail.push_back(t);
+    }
+    void undo(const trail_entry& t);
+
+    // bridge maintenance: while the bridges are marked, deleting an edge keeps them marked:
+    //  deleting a bridge doesn't turn any other edge into a bridge, so we just count the new component
+    //  deleting a non-bridge only records its endpoints; when the bridges are queried the next time, repair_bridges()
+    //  looks for new bridges in the 2-edge-connected components containing them, instead of in the whole graph
+    // attaching an edge to an isolated vertex creates a bridge and leaves all other bridges alone, any other
+    // new edge makes us forget the bridges
+    vector<uint> bridge_repairs;
+    unordered_set<uint> dirty_two_eccs;
+    uint next_two_ecc;
+
+    // the per-vertex fields that the bridge and subtree computations read and write for all vertices at once live in
+    // parallel arrays indexed by vertex index (instead of in the vertex records), so they can be scanned and reset in bulk:
+    //  IncidentBridges: the number of incident bridges
+    //  TwoEcc:          the label of the 2-edge-connected component (valid while the bridges are marked)
+    //  ParentArc:       the arc to the parent, no_index if we don't know it
+    // changing a single entry is logged as FieldValue and replacing a whole array as FieldArray, keeping the old array
+    enum hot_field {IncidentBridges, TwoEcc, ParentArc, num_hot_fields};
+    vector<uint> hot_fields[num_hot_fields];
+    vector<vector<uint> > saved_fields;
+    inline void set_field(const hot_field f, const uint i, const uint value){
+      uint& x(hot_fields[f][i]);
+      if(x == value) return;
+      // vertices that were created since the last checkpoint disappear on rollback anyways
+      if(logging() && (i < checkpoints.back().current_id)) log(FieldValue, i, f, x);
+      x = value;
+    }
+    // replace the array of f by values (and leave the old array in values, if we are not logging)
+    void replace_field(const hot_field f, vector<uint>& values);
+
+    // scratch space of the bridge finders, indexed by vertex index; it is kept apart from the vertices, since only the
+    // DFSs need it, and it is only allocated once somebody asks for it (see prepare_tarjan_infos())
+    vector<tarjan_info_t> tarjan_store;
+
     void compute_bridges(edgelist& bridgelist, list<uint>& split_off_sizes);
+    void repair_bridges();
+    // label the 2-edge-connected components containing the vertices vs, each with a label no other component has
+    void label_two_eccs(const vector<vertex_p>& vs);
+    // forget about the bridges
+    void invalidate_bridges();
+    // remove the arc at position pos from an adjacency list, keeping the order of the remaining arcs
+    void remove_arc(adjacency& adj, const uint pos);
+    // put the arc back at position pos into an adjacency list
+    void insert_arc(adjacency& adj, const uint pos, const uint arc);
+    // register/unregister an arc in the neighbor index of its tail (creating the index if the tail's degree gets large)
+    void index_arc(vertex& tail, const uint arc);
+    void unindex_arc(vertex& tail, const uint arc);
+    // maintain the segments of the adjacency lists (see adjacency::segments)
+    void segment_insert(vertex& tail, const uint arc);
+    void segment_remove(vertex& tail, const uint arc);
+    void segment_swap(adjacency& adj, const uint i, const uint j);
+    // move an arc into the segment it belongs to according to its is_bridge flag and the degree of its head
+    void classify_arc(const uint arc);
+    // the degree of v changed, so the arcs leading to v may have become (or ceased to be) pendant
+    void update_pendant_arcs(vertex& v);
+    // update everything but the adjacency lists and the indices for the deletion of the edge of the given arc
+    void account_deletion(const uint arc);
+
+    // the degree index: the vertices of each degree and the vertices with nldeg at least 3, each in a bucket
+    // it is updated in constant time whenever an arc is added to or removed from an adjacency list, so the
+    // consumers can get their candidates without scanning or sorting all vertices
+    // the buckets are in no particular order, degree_pos and high_nldeg_pos hold the position of each vertex in them
+    vector<vector<uint> > degree_bucket;
+    vector<uint> degree_pos;
+    uint top_degree;
+    vector<uint> high_nldeg;
+    vector<uint> high_nldeg_pos;
+    static inline void bucket_insert(vector<uint>& bucket, vector<uint>& pos, const uint i){
+      pos[i] = bucket.size();
+      bucket.push_back(i);
+    }
+    static inline void bucket_remove(vector<uint>& bucket, vector<uint>& pos, const uint i){
+      const uint last(bucket.back());
+      bucket[pos[i]] = last;
+      pos[last] = pos[i];
+      bucket.pop_back();
+    }
+    // move vertex i from the bucket of degree from to the bucket of degree to
+    inline void change_degree(const uint i, const uint from, const uint to){
+      bucket_remove(degree_bucket[from], degree_pos, i);
+      if(degree_bucket.size() <= to) degree_bucket.resize(to + 1);
+      bucket_insert(degree_bucket[to], degree_pos, i);
+      if(to > top_degree) top_degree = to; else while(top_degree && degree_bucket[top_degree].empty()) --top_degree;
+    }
+    // the arc (which has just been added or removed) changed the degree of its tail
+    // this updates the degree buckets and the nldegs of the tail and of the neighbors that see it become (or cease to be) a leaf
+    void index_degree(vertex& tail, const uint arc, const bool added);
+    // count or uncount a vertex that becomes present or absent
+    // (this also takes care of the arcs it still has, which only happens when whole components are detached)
+    void index_vertex(const vertex& v, const bool present);
+    inline void add_to_nldeg(vertex& v, const int diff){
+      const bool was_high(v.non_leaves > 2);
+      v.non_leaves += diff;
+      if(was_high != (v.non_leaves > 2)){
+        if(was_high) bucket_remove(high_nldeg, high_nldeg_pos, v.id); else bucket_insert(high_nldeg, high_nldeg_pos, v.id);
+      }
+    }
+
+    // the Zobrist fingerprint: the XOR of the keys of all present vertices and all edges (see vertex_key() and edge_key())
+    // both index_vertex() and index_degree() keep it up to date, so it changes with every modification and rollback
+    uint64_t fprint;
+
+    // the triangle index: triangle_count[i] is the number of triangles containing vertex i and triangle_corners is
+    // the sum of the triangle_counts of all vertices that are present (so each triangle is counted 3 times)
+    // it is built when it is first asked for and from then on, it is updated whenever an edge is added or removed
+    vector<uint> triangle_count;
+    uint triangle_corners;
+    bool triangles_indexed;
+    void build_triangle_index();
+    // the edge between u and w has just been added (diff = 1) or removed (diff = -1), so count or uncount its triangles
+    // except for those containing one of the edges in gone (given by their arc index / 2)
+    void index_triangles(const uint u, const uint w, const int diff, const unordered_set<uint>* const gone = NULL);
+    // scratch space for index_triangles(), so we don't allocate for each edge
+    vector<uint> tri_nbrs_u, tri_nbrs_w, tri_common;
+    // put the indices of the neighbors of v into nbrs, sorted
+    void sorted_neighbors(const vertex& v, vector<uint>& nbrs) const;
+    // move the vertices in order (which have arcs arcs in total and no neighbors outside order) to gto, in this order
+    // if keep_flags is set, then the permanent edges and protected vertices are kept
+    void move_vertices(const vector<vertex_p>& order, const uint arcs, graph& gto, const bool keep_flags);
   public:
+    // make room for the tarjan infos of all vertices and, if requested, reset all of them at once
+    void prepare_tarjan_infos(const bool reset);
+    // forget the parents and the trr_infos of all vertices, the trr_infos are moved to the modification trail instead
+    // of being copied there, since they are cleared anyways
+    void reset_subtrees();
+    // get the tarjan infos of v; prepare_tarjan_infos() must have been called since v was created
+    inline tarjan_info_t& tarjan_infos(const vertex_p& v) {return tarjan_store[v.index()];}
+
     uint current_dfs_id;
+    // number of vertex ids given out so far, all vertex ids are smaller than current_id
     uint current_id;
     // are the bridges up to date?
     bool bridges_marked;
@@ -336,20 +709,23 @@ namespace cr{
     uint edgenum;
     uint cc_number;
 
-    list<vertex> vertices;
+    vertex_list vertices;
+
+    // names and edges of the input graph
+    shared_ptr<input_info_t> input;
 
     /****************************
      * constructors
      ***************************/
-    graph():current_dfs_id(1),current_id(0),bridges_marked(false),subtrees_marked(false),edgenum(0),cc_number(0),vertices(){}
+    graph():vertex_store(),arc_store(),present(),trail(),saved_states(),checkpoints(),current_stamp(0),bridge_repairs(),dirty_two_eccs(),next_two_ecc(0),hot_fields(),saved_fields(),tarjan_store(),degree_bucket(),degree_pos(),top_degree(0),high_nldeg(),high_nldeg_pos(),fprint(0),triangle_count(),triangle_corners(0),triangles_indexed(false),tri_nbrs_u(),tri_nbrs_w(),tri_common(),current_dfs_id(1),current_id(0),bridges_marked(false),subtrees_marked(false),edgenum(0),cc_number(0),vertices(this),input(make_shared<input_info_t>()){}
     // initialize while translating the edge list el
     // note that the edgelist may change, but the pointer wont
     graph(const graph& g, edgelist * const el);
-    graph(const graph& g, unordered_map<uint, vertex_p>* id_to_vertex = NULL);
-    graph(const graph& g, edge_p& e){
-      edgelist el; el.push_back(e);
-      graph(g, &el);
-    }
+    graph(const graph& g, vector<vertex_p>* id_to_vertex = NULL);
+    graph(const graph& g, edge_p& e);
+
+    // handles point into the graph, so it cannot be assigned
+    graph& operator=(const graph& g) = delete;
 
     /**************************
      * read-only informative functions
@@ -365,15 +741,57 @@ namespace cr{
     // find a vertex by specifying its id, return vertices.end() if its just not there
     vertex_p find_vertex_by_id(const uint id);
 
+    // the number of vertices of degree d, the i'th of them and the maximum degree of the graph (0 for the empty graph)
+    // the vertices of each degree are in no particular order, and the order changes as the graph is modified
+    inline uint vertices_of_degree(const uint d) const {return (d < degree_bucket.size()) ? degree_bucket[d].size() : 0;}
+    inline vertex_p vertex_of_degree(const uint d, const uint i) {return vertex_p(this, degree_bucket[d][i]);}
+    inline uint max_degree() const {return top_degree;}
+    // the number of vertices that have at least 3 non-leaf neighbors and the i'th of them (in no particular order)
+    inline uint num_high_nldeg() const {return high_nldeg.size();}
+    inline vertex_p high_nldeg_vertex(const uint i) {return vertex_p(this, high_nldeg[i]);}
+    // a copy of the vertices with at least 3 non-leaf neighbors in order of their index, for callers that modify the graph
+    vector<vertex_p> high_nldeg_vertices();
+
+    // a 64-bit fingerprint of the graph, identifying the vertices by their ids, in constant time
+    // two graphs with the same vertex ids and edges between them have the same fingerprint, different graphs collide
+    // with probability about 2^-64; note that copies of a graph may number their vertices differently
+    inline uint64_t fingerprint() const {return fprint;}
+
+    // the number of triangles containing v and the number of triangles in the graph (building the triangle index if needed)
+    inline uint triangles_at(const vertex_p& v){
+      if(!triangles_indexed) build_triangle_index();
+      return triangle_count[v.index()];
+    }
+    inline uint num_triangles(){
+      if(!triangles_indexed) build_triangle_index();
+      return triangle_corners / 3;
+    }
+
     // simple output,
     // Prints the edgelist of g (plus the number of vertices/edges in verbose mode)
     // out: output stream.
     void write_to_stream(ostream& out, const bool verbose = true) const;
+    // output a solution, translating its input edges to the names of their endpoints
+    void write_solution(ostream& out, const solution_t& sol) const;
 
-    // test whether two graphs are equal (including vertex id's and _the_order_in_the_vertex_list)
-    // TODO: the second condition can be dropped if we keep a map:id->vertex in the graph instead of a list<vertex>
+    // test whether two graphs are equal (including vertex id's)
     bool operator==(const graph& g) const;
 
+    /************************
+     * modification trail
+     ************************/
+
+    // take a checkpoint: from now on, all modifications of the graph are logged until rollback() is called
+    // checkpoints nest, rollback() returns the graph to the state it had at the most recent checkpoint
+    // this lets us branch on a graph in place instead of copying it for each branch
+    // NOTE: dfs_ids and tarjan_infos are scratch space and are not restored
+    void checkpoint();
+    void rollback();
+
+    // save the state of v or the flags of e (and its reversal) in the trail, if we are logging
+    void save_vertex_state(vertex& v);
+    void save_arc_flags(const edge& e);
+
     /************************
      * graph modifications
      ************************/
@@ -381,16 +799,24 @@ namespace cr{
     // clear the graph (remove all vertices and edges)
     void clear();
 
-    // add a vertex given as id to the graph and return a fresh iterator to it
+    // add a vertex with a new id to the graph and return a fresh handle to it
     vertex_p add_vertex_fast();
+    // add a vertex with a new name, interning the name in the input infos
     vertex_p add_vertex_fast(const string& s);
-    vertex_p add_vertex_fast(const uint id);
-    vertex_p add_vertex_fast(const uint id, const string& s);
-    vertex_p add_vertex_secure(const uint id);
+    // add a vertex with the name of some other vertex
+    vertex_p add_vertex_fast(const uint name);
+    // make room for the given number of vertices and edges, for callers that know the size of the graph in advance
+    void reserve(const uint vertices, const uint edges);
+    // replace the graph by the vertices 0 to n-1, named 0 to n-1 (see input_info_t), and the arcs given in CSR form:
+    // the adjacency list of vertex i is ranks[offsets[i]] to ranks[offsets[i+1]-1], in this order, and arc ranks[s]
+    // leads to targets[s]; the ranks are a permutation of 0 to offsets[n]-1 and the arcs 2j and 2j+1 reverse each other
+    // the arcs get their ranks as indices and the indices are built in one pass afterwards, instead of edge by edge as
+    // with add_edge_fast(); permanent (if given) has an entry for each edge and the graph must not be logging
+    void build_csr(const uint n, const uint* offsets, const uint* targets, const uint* ranks, const vector<bool>* permanent = NULL);
 
     // add an edge to the graph - modify adjacency lists
     // this is the _fast_ variant: no check is done whether this edge already exists!
-    edge_p add_edge_fast(const vertex_p& u, const vertex_p& v);
+    edge_p add_edge_fast(const vertex_p& u, const vertex_p& v, const uint input_id = no_index);
     edge_p add_edge_fast(const vertex_p& u, const vertex_p& v, const edge_pc& copy_from);
 
     // add an edge to the graph - modify adjacency lists
@@ -403,29 +829,43 @@ namespace cr{
 
     // delete an edge, return next edge_p in "current" adjacency list
     edge_p delete_edge(const edge_p& e);
+    // delete a batch of distinct edges, cheaper than deleting them one by one if they share endpoints
     void delete_edges(const edgelist& l);
 
     // delete the connected component containing vertex v
     void delete_component(const vertex_p& v);
 
-    // delete the connected component containing vertex v
-    void copy_component(const vertex_p& v, graph& gto, unordered_map<uint,vertex_p>* id_to_vertex = NULL);
-    void copy_graph(const vertex_p& v, graph& gto, unordered_map<uint,vertex_p>* id_to_vertex = NULL);
+    // copy the connected component containing vertex v to gto
+    void copy_component(const vertex_p& v, graph& gto, vector<vertex_p>* id_to_vertex = NULL);
+    // move the connected component containing vertex v to gto and return the vertex representing v in gto
+    // this takes time linear in the size of the component (the rest of the graph is not touched)
+    vertex_p move_component(const vertex_p& v, graph& gto);
+    // move all vertices to gto, keeping permanent edges and protected vertices
+    // gto gets them in an order that puts neighbors close to each other in memory (see move_all() in graphs.cpp)
+    void move_all(graph& gto);
 
     // count the number of vertices in the component of v
     uint component_size(const vertex_p& v);
 
     // simple input
-    // reads the edgelist into g
+    // reads the graph in any format we know (see read_graph()) into g
     // in: input stream.
     void read_from_stream(istream& in);
 
     // simple input
-    // reads the edgelist into f
-    // infile: input file namf
-    void read_from_file(const char* infile);
-
-    // mark all bridges
+    // reads the graph in any format we know (see read_graph()) into g, mapping the file into memory if possible
+    // infile: input file name, threads: the number of threads to parse with (0 = one per core, for large files)
+    // malformed input is reported by throwing an input_error
+    void read_from_file(const char* infile, const uint threads = 0);
+
+    // declare the current graph to be the input: number its edges and remember their endpoints in the input infos
+    // (this is done by the readers, but has to be called by whoever constructs an input graph by hand)
+    void set_as_input();
+    // replace the graph by the input graph it was derived from, as recorded in the input infos by set_as_input()
+    // (vertices that are isolated in the input do not come back unless they have a name)
+    void rebuild_input();
+
+    // mark all bridges (and compute cc_number)
     void mark_bridges();
     // mark & return all bridges
     edgelist get_bridges();
@@ -438,7 +878,9 @@ namespace cr{
     weighted_edges get_weighted_Bbridges();
 
     // add a graph to this one
-    void add_disjointly(const graph& Gfrom, unordered_map<uint, vertex_p>* id_to_vertex = NULL);
+    // if id_to_vertex is given, then it maps the id of each vertex of Gfrom to its copy afterwards (it's indexed by the
+    // ids of Gfrom, so it has Gfrom.current_id entries and those of deleted vertices are invalid handles)
+    void add_disjointly(const graph& Gfrom, vector<vertex_p>* id_to_vertex = NULL);
 
 
 //    void update_subtree_NH();
@@ -447,9 +889,118 @@ namespace cr{
   };
 
 
+  /***************************
+   * handle implementations
+   ***************************/
+
+  template<class G, class V>
+  inline V& vertex_handle<G, V>::operator*() const {return g->vertex_store[idx];}
+  template<class G, class V>
+  inline V* vertex_handle<G, V>::operator->() const {return &(g->vertex_store[idx]);}
+
+  // advance to the next vertex that has not been deleted
+  template<class G, class V>
+  inline vertex_handle<G, V>& vertex_handle<G, V>::operator++(){
+    const uint n(g->current_id);
+    do ++idx; while((idx < n) && !g->present[idx]);
+    if(idx >= n) idx = no_index;
+    return *this;
+  }
 
+  template<class G, class E>
+  inline E& edge_handle<G, E>::operator*() const {return g->arc_store[idx];}
+  template<class G, class E>
+  inline E* edge_handle<G, E>::operator->() const {return &(g->arc_store[idx]);}
+
+  // advance to the next arc in the adjacency list of the tail
+  template<class G, class E>
+  inline edge_handle<G, E>& edge_handle<G, E>::operator++(){
+    const uint next(g->arc_store[idx].pos + 1);
+    const adjacency& adj(g->vertex_store[g->arc_store[idx ^ 1].head.index()].adj_list);
+    idx = (next < adj.arcs.size()) ? adj.arcs[next] : no_index;
+    return *this;
+  }
 
+  // go back to the previous arc in the adjacency list of the tail
+  template<class G, class E>
+  inline edge_handle<G, E>& edge_handle<G, E>::operator--(){
+    const uint pos(g->arc_store[idx].pos);
+    const adjacency& adj(g->vertex_store[g->arc_store[idx ^ 1].head.index()].adj_list);
+    idx = pos ? adj.arcs[pos - 1] : no_index;
+    return *this;
+  }
+
+  inline void vertex::save_state(){
+    adj_list.g->save_vertex_state(*this);
+  }
+  inline uint vertex::incident_bridges() const{
+    return adj_list.g->hot_fields[graph::IncidentBridges][id];
+  }
+  inline bool vertex::has_parent() const{
+    return adj_list.g->hot_fields[graph::ParentArc][id] != no_index;
+  }
+  inline void vertex::invalidate_parent(){
+    adj_list.g->set_field(graph::ParentArc, id, no_index);
+  }
+  inline void vertex::set_parent(const edge_p& e){
+    adj_list.g->set_field(graph::ParentArc, id, e.index());
+  }
+
+  inline vertex::operator string() const{
+    return (name == no_index) ? string("?") : adj_list.g->input->name(name);
+  }
+
+  inline void edge::mark_permanent(const bool mark) {
+    head.get_graph()->save_arc_flags(*this);
+    is_permanent = mark;
+    get_reversed()->is_permanent = mark;
+  }
+  inline void edge::mark_bridge(const bool mark){
+    graph* const g(head.get_graph());
+    g->save_arc_flags(*this);
+    is_bridge = mark;
+    g->set_field(graph::IncidentBridges, head.index(), head->incident_bridges() + (mark ? 1 : -1));
+
+    get_reversed()->is_bridge = mark;
+    const vertex_p tail(get_tail());
+    g->set_field(graph::IncidentBridges, tail.index(), tail->incident_bridges() + (mark ? 1 : -1));
+    g->classify_arc(index);
+    g->classify_arc(index ^ 1);
+  }
+  inline void edge::set_input_id(const uint id){
+    head.get_graph()->save_arc_flags(*this);
+    input_id = id;
+    get_reversed()->input_id = id;
+  }
+
+  inline vertex_p vertex_list::begin(){
+    vertex_p v(g, 0);
+    if(g->current_id == 0) return end();
+    if(!g->present[0]) ++v;
+    return v;
+  }
+  inline vertex_p vertex_list::end(){return vertex_p(g, no_index);}
+  inline vertex_pc vertex_list::begin() const{
+    vertex_pc v(g, 0);
+    if(g->current_id == 0) return end();
+    if(!g->present[0]) ++v;
+    return v;
+  }
+  inline vertex_pc vertex_list::end() const {return vertex_pc(g, no_index);}
+
+
+
+  // get the edge from u to v, or u->adj_list.end() if u and v are not adjacent
+  // if neither u nor v have a neighbor index, then both have small degree and we just scan u's adjacency list
   inline edge_p find_edge(const vertex_p u, const vertex_p v){
+    if(u->nbr_index){
+      const unordered_map<uint, uint>::const_iterator i(u->nbr_index->find(v.index()));
+      return (i != u->nbr_index->end()) ? edge_p(u.get_graph(), i->second) : u->adj_list.end();
+    }
+    if(v->nbr_index){
+      const unordered_map<uint, uint>::const_iterator i(v->nbr_index->find(u.index()));
+      return (i != v->nbr_index->end()) ? edge_p(u.get_graph(), i->second ^ 1) : u->adj_list.end();
+    }
     for(edge_p e = u->adj_list.begin(); e != u->adj_list.end(); ++e)
       if(e->head == v) return e;
     return u->adj_list.end();
@@ -476,7 +1027,7 @@ namespace cr{
   inline edge_p get_next_on_deg2path(const edge_p& e, bool* success = NULL){
     const vertex_p& v(e->head);
     if(v->cyc_core_degree() != 2){
-      FAIL("epic fail in get_next_on_deg2path(" << *e << ")");
+      FAIL("epic fail in get_next_on_deg2path(" << (string)*e << ")");
     } else
       return v->first_cyclic_core_neighbor_except(e->get_tail(), success);
   }
@@ -495,18 +1046,18 @@ namespace cr{
   edgelist get_a_FES(graph& g);
 
   // split a component off of a graph
-  void split_off_component(graph& g, graph& comp, unordered_map<uint, vertex_p>* id_to_vertex = NULL);
-  
+  void split_off_component(graph& g, graph& comp);
+
 
   inline edge_p first_neighbor_non_dfs_id(const vertex_p& v, const uint dfs_id){
-    list<edge>& adj(v->adj_list);
-    for(edge_p e = adj.begin(); e != adj.end(); ++e)
+    for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e)
       if(e->head->dfs_id != dfs_id) return e;
+    return v->adj_list.end();
   }
 
-  // TODO: make this more efficient!!
-  inline edge_p convert_edge(const edge_p& e, const unordered_map<uint, vertex_p>& id_to_vertex){
-    return find_edge(id_to_vertex.at(e->get_tail()->id), id_to_vertex.at(e->head->id));
+  // translate an edge to the corresponding edge of a copy of its graph
+  inline edge_p convert_edge(const edge_p& e, const vector<vertex_p>& id_to_vertex){
+    return find_edge(id_to_vertex[e->get_tail()->id], id_to_vertex[e->head->id]);
   }
 
   class instance {
@@ -521,9 +1072,13 @@ namespace cr{
     // instanciate, translating the edgelist el to the new graph
     // note that the edgelist may change, but the pointer wont
     instance(const instance& I, edgelist * const el):g(I.g,el),k(I.k){}
-    instance(const instance& I, unordered_map<uint, vertex_p>* id_to_vertex = NULL):g(I.g,id_to_vertex),k(I.k){}
+    instance(const instance& I, vector<vertex_p>* id_to_vertex = NULL):g(I.g,id_to_vertex),k(I.k){}
     instance(const instance& I, edge_p& e):g(I.g,e),k(I.k){}
 
+    // a fingerprint of the search state: the graph and the remaining budget
+    // (the budget gets a key whose upper half is no_index, which no vertex or edge key has)
+    inline uint64_t fingerprint() const {return g.fingerprint() ^ mix64(((uint64_t)no_index << 32) | (uint)k);}
+
     // delete an edge, registering it in the solution
     edge_p delete_edge(const edge_p& e){
       // decrement k
@@ -531,22 +1086,24 @@ namespace cr{
       // and do the actual deleting
       return g.delete_edge(e);
     }
-    
+
     edge_p delete_edge(const edge_p& e, solution_t& solution){
       // register e in the solution
-      solution += (string)*e;
+      solution += e->input_id;
 
       // do the edge deletion
       return delete_edge(e);
     }
 
+    // delete a batch of distinct edges (see graph::delete_edges())
     void delete_edges(const edgelist& l){
-      for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e)
-        delete_edge(*e);
+      k -= l.size();
+      g.delete_edges(l);
     }
     void delete_edges(const edgelist& l, solution_t& solution){
       for(edgelist::const_iterator e = l.begin(); e != l.end(); ++e)
-        delete_edge(*e, solution);
+        solution += (*e)->input_id;
+      delete_edges(l);
     }
 
   };
@@ -554,33 +1111,38 @@ namespace cr{
   // convert an edgelist to a solution_t
   inline solution_t edgelist_to_solution(const edgelist& el){
     solution_t result;
-    for(edge_ppc e = el.begin(); e != el.end(); ++e) result += (string)**e;
+    for(edge_ppc e = el.begin(); e != el.end(); ++e) result += (*e)->input_id;
     return result;
   }
 
 
 
 
-};
-
 //ostream& operator<<(ostream& os, const cr::solution_t& s) {return os << s.i; }
 
-inline ostream& operator<<(ostream& os, const cr::vertex& v) {return os << (string)v; }
-inline ostream& operator<<(ostream& os, const cr::vertex_p& v) {return os << (const cr::vertex&)(*v); }
-inline ostream& operator<<(ostream& os, const cr::vertex_pc& v) {return os << (const cr::vertex&)(*v); }
+  inline ostream& operator<<(ostream& os, const cr::vertex& v) {return os << (string)v; }
+  inline ostream& operator<<(ostream& os, const cr::vertex_p& v) {return os << *v; }
+  inline ostream& operator<<(ostream& os, const cr::vertex_pc& v) {return os << *v; }
 
-inline ostream& operator<<(ostream& os, const cr::edge& e) {return os << (string)e;}
-inline ostream& operator<<(ostream& os, const cr::edge_p& e) {return os << (cr::edge)*e;}
-inline ostream& operator<<(ostream& os, const cr::edge_pc& e) {return os << (cr::edge)*e;}
+  inline ostream& operator<<(ostream& os, const cr::edge& e) {return os << (string)e;}
+  inline ostream& operator<<(ostream& os, const cr::edge_p& e) {return os << *e;}
+  inline ostream& operator<<(ostream& os, const cr::edge_pc& e) {return os << *e;}
 
-inline ostream& operator<<(ostream& os, const cr::trr_info_t& t){
-  return os << "L="<<t.leaves<<" P="<<t.ptwos<<" Y="<<t.ygraphs<<" 2C="<<t.tclaws;
-}
-inline ostream& operator<<(ostream& os, const cr::graph& g){
-  g.write_to_stream(os);
-  return os;
-}
+  inline ostream& operator<<(ostream& os, const cr::pendant_list& l){
+    os << '(';
+    if(l.empty()) return os << ')';
+    for(const edge_p e : l) os << e << ' ';
+    return os << '\b' << ')';
+  }
+  inline ostream& operator<<(ostream& os, const cr::trr_info_t& t){
+    return os << "L="<<t.leaves<<" P="<<t.ptwos<<" Y="<<t.ygraphs<<" 2C="<<t.tclaws;
+  }
+  inline ostream& operator<<(ostream& os, const cr::graph& g){
+    g.write_to_stream(os);
+    return os;
+  }
 
+};
 
 
 
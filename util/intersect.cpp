@@ -0,0 +1,81 @@
+#include "intersect.hpp"
+#include <immintrin.h>
+
+namespace cr {
+
+  typedef uint (*intersect_fn)(const uint*, const uint, const uint*, const uint, uint*);
+
+  // plain merge, also used for the tails the vector versions leave over
+  uint intersect_scalar(const uint* a, const uint na, const uint* b, const uint nb, uint* out){
+    uint i = 0, j = 0, k = 0;
+    while((i < na) && (j < nb)){
+      if(a[i] < b[j]) ++i;
+      else if(a[i] > b[j]) ++j;
+      else {
+        out[k++] = a[i];
+        ++i;
+        ++j;
+      }
+    }
+    return k;
+  }
+
+  // the vector versions compare a block of a against all rotations of a block of b, which tells us which elements of
+  // the a-block occur in the b-block; then, the block with the smaller maximum is done and we advance past it
+  // since the elements are distinct, each element of a matches in at most one b-block, so nothing is reported twice
+
+  __attribute__((target("avx2")))
+  uint intersect_avx2(const uint* a, const uint na, const uint* b, const uint nb, uint* out){
+    uint i = 0, j = 0, k = 0;
+    const __m256i rotate(_mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0));
+    while((i + 8 <= na) && (j + 8 <= nb)){
+      const __m256i va(_mm256_loadu_si256((const __m256i*)(a + i)));
+      __m256i vb(_mm256_loadu_si256((const __m256i*)(b + j)));
+      __m256i found(_mm256_cmpeq_epi32(va, vb));
+      for(uint r = 1; r < 8; ++r){
+        vb = _mm256_permutevar8x32_epi32(vb, rotate);
+        found = _mm256_or_si256(found, _mm256_cmpeq_epi32(va, vb));
+      }
+      for(uint mask = _mm256_movemask_ps(_mm256_castsi256_ps(found)); mask; mask &= mask - 1)
+        out[k++] = a[i + __builtin_ctz(mask)];
+      const uint amax(a[i + 7]), bmax(b[j + 7]);
+      if(amax <= bmax) i += 8;
+      if(bmax <= amax) j += 8;
+    }
+    return k + intersect_scalar(a + i, na - i, b + j, nb - j, out + k);
+  }
+
+  __attribute__((target("avx512f")))
+  uint intersect_avx512(const uint* a, const uint na, const uint* b, const uint nb, uint* out){
+    uint i = 0, j = 0, k = 0;
+    while((i + 16 <= na) && (j + 16 <= nb)){
+      const __m512i va(_mm512_loadu_si512(a + i));
+      __m512i vb(_mm512_loadu_si512(b + j));
+      __mmask16 found(_mm512_cmpeq_epi32_mask(va, vb));
+      for(uint r = 1; r < 16; ++r){
+        // rotate by one (the unmasked alignr makes gcc 12 warn about an uninitialized register)
+        vb = _mm512_mask_alignr_epi32(vb, 0xffff, vb, vb, 1);
+        found |= _mm512_cmpeq_epi32_mask(va, vb);
+      }
+      _mm512_mask_compressstoreu_epi32(out + k, found, va);
+      k += __builtin_popcount(found);
+      const uint amax(a[i + 15]), bmax(b[j + 15]);
+      if(amax <= bmax) i += 16;
+      if(bmax <= amax) j += 16;
+    }
+    return k + intersect_scalar(a + i, na - i, b + j, nb - j, out + k);
+  }
+
+  static intersect_fn pick_intersect(){
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return intersect_avx512;
+    if(__builtin_cpu_supports("avx2")) return intersect_avx2;
+    return intersect_scalar;
+  }
+  static const intersect_fn best_intersect(pick_intersect());
+
+  uint intersect_sorted(const uint* a, const uint na, const uint* b, const uint nb, uint* out){
+    return best_intersect(a, na, b, nb, out);
+  }
+
+}
@@ -0,0 +1,27 @@
+#ifndef INTERSECT_HPP
+#define INTERSECT_HPP
+
+#include "defs.hpp"
+
+namespace cr {
+
+  // intersect the sorted arrays a and b (each without duplicates) and write the common elements to out, in order
+  // out must have room for min(na, nb) elements; returns the number of common elements
+  // this uses AVX-512 or AVX2 if the CPU we're running on supports it (checked once, at startup)
+  uint intersect_sorted(const uint* a, const uint na, const uint* b, const uint nb, uint* out);
+
+  // if one list is more than this many times longer than the other, then it's cheaper to look up each element of the
+  // shorter one in the longer one (which is indexed if it's long, see nbr_index_threshold) than to sort and intersect
+  const uint intersect_skew = 16;
+  // if the shorter list is shorter than this, then the vector versions don't get to do anything, so look up its elements
+  const uint intersect_min_length = 8;
+
+  // the versions intersect_sorted() picks from, exposed for testing
+  // the vector versions may only be called if the CPU supports AVX2 or AVX-512F, respectively
+  uint intersect_scalar(const uint* a, const uint na, const uint* b, const uint nb, uint* out);
+  uint intersect_avx2(const uint* a, const uint na, const uint* b, const uint nb, uint* out);
+  uint intersect_avx512(const uint* a, const uint na, const uint* b, const uint nb, uint* out);
+
+}
+
+#endif
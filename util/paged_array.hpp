@@ -0,0 +1,82 @@
+#ifndef PAGED_ARRAY_HPP
+#define PAGED_ARRAY_HPP
+
+#include <vector>
+#include <new>
+#include <utility>
+
+#include "defs.hpp"
+
+namespace cr {
+
+  // a growable array whose elements are stored in fixed-size pages of contiguous memory
+  // unlike a vector, growing never moves existing elements, so references to them stay valid
+  // (the graph hands out references into its vertex and edge storage all the time)
+  template<class T, uint page_bits = 10>
+  class paged_array {
+    static const uint page_size = 1U << page_bits;
+    static const uint page_mask = page_size - 1;
+
+    std::vector<T*> pages;
+    uint count;
+
+    // get the address of the i'th slot, without checking whether it holds an element
+    inline T* slot(const uint i) const {
+      return pages[i >> page_bits] + (i & page_mask);
+    }
+
+  public:
+    paged_array():pages(),count(0){}
+    ~paged_array(){ clear(); }
+
+    // the elements know where they live, so copying them around makes no sense
+    paged_array(const paged_array&) = delete;
+    paged_array& operator=(const paged_array&) = delete;
+
+    inline uint size() const { return count; }
+    inline bool empty() const { return count == 0; }
+
+    inline T& operator[](const uint i) { return *slot(i); }
+    inline const T& operator[](const uint i) const { return *slot(i); }
+
+    inline T& back() { return *slot(count - 1); }
+    inline const T& back() const { return *slot(count - 1); }
+
+    // construct a new element at the end of the array and return a reference to it
+    template<class... Args>
+    T& emplace_back(Args&&... args){
+      if((count >> page_bits) == pages.size())
+        pages.push_back(static_cast<T*>(::operator new(sizeof(T) * page_size)));
+      T* const result(slot(count));
+      new(result) T(std::forward<Args>(args)...);
+      ++count;
+      return *result;
+    }
+
+    // destroy the last element
+    void pop_back(){
+      slot(--count)->~T();
+    }
+
+    // reserve pages for at least n elements
+    void reserve(const uint n){
+      while((pages.size() << page_bits) < n)
+        pages.push_back(static_cast<T*>(::operator new(sizeof(T) * page_size)));
+    }
+
+    // destroy all elements, but keep the pages for the elements to come
+    void reset(){
+      while(count) pop_back();
+    }
+
+    // destroy all elements and release the memory
+    void clear(){
+      reset();
+      for(T* page : pages) ::operator delete(page);
+      pages.clear();
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include "small_graph.hpp"
+#include <algorithm>
+
+namespace cr {
+
+  const uint small_graph::max_vertices;
+
+  // iterate over the set bits of a word
+  #define FOR_BITS(v, word) for(small_graph::row_t _w = (word), v = 0; _w && ((v = __builtin_ctzll(_w)), true); _w &= _w - 1)
+
+  small_graph::small_graph(graph& g):n(g.vertices.size()){
+    if(n > max_vertices) FAIL("cannot put a graph with "<<n<<" vertices into a small_graph");
+    // give the vertices consecutive bits and remember which bit we gave to which vertex index
+    vector<pair<uint, uint> > bit_of;
+    bit_of.reserve(n);
+    vertex_of.reserve(n);
+    for(vertex_p v = g.vertices.begin(); v != g.vertices.end(); ++v){
+      bit_of.push_back(make_pair(v.index(), vertex_of.size()));
+      vertex_of.push_back(v);
+    }
+    sort(bit_of.begin(), bit_of.end());
+
+    for(uint u = 0; u < n; ++u){
+      adj[u] = permanent[u] = 0;
+      const vertex_p& v(vertex_of[u]);
+      for(edge_p e = v->adj_list.begin(); e != v->adj_list.end(); ++e){
+        const uint w(lower_bound(bit_of.begin(), bit_of.end(), make_pair(e->head.index(), 0u))->second);
+        adj[u] |= bit(w);
+        if(e->is_permanent) permanent[u] |= bit(w);
+      }
+    }
+  }
+
+  uint small_graph::num_edges() const{
+    uint result = 0;
+    for(uint u = 0; u < n; ++u) result += degree(u);
+    return result / 2;
+  }
+
+  uint small_graph::num_components() const{
+    const row_t all((n == max_vertices) ? ~(row_t)0 : bit(n) - 1);
+    row_t seen = 0;
+    uint result = 0;
+    // grow each component layer by layer
+    while(seen != all){
+      row_t frontier(bit(__builtin_ctzll(~seen)));
+      seen |= frontier;
+      while(frontier){
+        row_t next = 0;
+        FOR_BITS(v, frontier) next |= adj[v];
+        frontier = next & ~seen;
+        seen |= frontier;
+      }
+      ++result;
+    }
+    return result;
+  }
+
+  uint small_graph::star_packing() const{
+    // the edges that are in no star yet
+    row_t left[max_vertices];
+    for(uint u = 0; u < n; ++u) left[u] = adj[u];
+    // go through the vertices in order of their degree
+    uint by_degree[max_vertices];
+    for(uint u = 0; u < n; ++u) by_degree[u] = u;
+    stable_sort(by_degree, by_degree + n, [this](const uint u, const uint v){return degree(u) < degree(v);});
+    uint k = 0;
+    for(uint i = 0; i < n; ++i){
+      const uint v(by_degree[i]);
+      // for each ray v-x-y, ray_end[x] has the bit of y; the edges xy of the rays are distinct
+      row_t ray_end[max_vertices];
+      row_t centers = 0;
+      FOR_BITS(x, left[v]){
+        row_t candidates(left[x] & ~bit(v));
+        FOR_BITS(y, candidates & centers) if(ray_end[y] & bit(x)) candidates &= ~bit(y);
+        if(candidates){
+          ray_end[x] = candidates & -candidates;
+          centers |= bit(x);
+        }
+      }
+      const uint rays(__builtin_popcountll(centers));
+      if(rays > 2){
+        // all but two rays have to be destroyed
+        k += rays - 2;
+        FOR_BITS(x, centers){
+          const uint y(__builtin_ctzll(ray_end[x]));
+          left[v] &= ~bit(x); left[x] &= ~bit(v);
+          left[x] &= ~bit(y); left[y] &= ~bit(x);
+        }
+      }
+    }
+    // finally, add an FES of the remaining edges
+    small_graph rest(*this);
+    for(uint u = 0; u < n; ++u) rest.adj[u] = left[u];
+    return k + rest.fes_size();
+  }
+
+  bool small_graph::find_triangle(uint t[3]) const{
+    for(uint u = 0; u < n; ++u)
+      // only look at neighbors v > u and common neighbors w > v, so each triangle is seen once
+      FOR_BITS(v, adj[u] & ~((bit(u) << 1) - 1)){
+        const row_t common(adj[u] & adj[v] & ~((bit(v) << 1) - 1));
+        if(common){
+          t[0] = u;
+          t[1] = v;
+          t[2] = __builtin_ctzll(common);
+          return true;
+        }
+      }
+    return false;
+  }
+
+  bool small_graph::find_short_cycle(vector<uint>& cycle, const uint max_len) const{
+    // do a BFS from each vertex r until two of its branches meet; the first meeting gives a closed walk through r of
+    // length 2d+1 (an edge inside layer d) or 2d+2 (a vertex with two parents in layer d) and the shortest closed walk
+    // over all r is a shortest cycle, so for its r, the two branches share only r
+    uint best_len = max_len + 1;
+    uint parent[max_vertices];
+    for(uint r = 0; r < n; ++r){
+      row_t seen(bit(r)), frontier(bit(r));
+      uint x = no_index, y = no_index, z = no_index;
+      for(uint d = 0; frontier && (2 * d + 1 < best_len); ++d){
+        // an edge between two vertices of the current layer closes a walk of length 2d+1
+        FOR_BITS(u, frontier) if(adj[u] & frontier) {
+          x = u;
+          y = __builtin_ctzll(adj[u] & frontier);
+          best_len = 2 * d + 1;
+          break;
+        }
+        if((x != no_index) || (2 * d + 2 >= best_len)) break;
+        // a vertex of the next layer with two neighbors in the current layer closes a walk of length 2d+2
+        row_t next = 0;
+        FOR_BITS(u, frontier) next |= adj[u];
+        next &= ~seen;
+        FOR_BITS(w, next){
+          const row_t parents(adj[w] & frontier);
+          parent[w] = __builtin_ctzll(parents);
+          if(parents & (parents - 1)){
+            x = parent[w];
+            y = __builtin_ctzll(parents & (parents - 1));
+            z = w;
+            best_len = 2 * d + 2;
+            break;
+          }
+        }
+        if(x != no_index) break;
+        seen |= next;
+        frontier = next;
+      }
+      if(x != no_index){
+        // the cycle is z (if any), x up to r, and then down to y
+        cycle.clear();
+        if(z != no_index) cycle.push_back(z);
+        for(; x != r; x = parent[x]) cycle.push_back(x);
+        cycle.push_back(r);
+        const uint down(cycle.size());
+        for(; y != r; y = parent[y]) cycle.push_back(y);
+        reverse(cycle.begin() + down, cycle.end());
+      }
+    }
+    return best_len <= max_len;
+  }
+
+  bool small_graph::find_2claw(uint claw[7]) const{
+    // without cycles of length 3 or 4, a vertex is the center of a 2-claw iff it has 3 neighbors of degree at least 2
+    // we prefer legs of degree 2, since all ways to break them are then part of the branching
+    for(uint c = 0; c < n; ++c) if(degree(c) >= 3){
+      row_t short_legs = 0, long_legs = 0;
+      FOR_BITS(x, adj[c]) if(degree(x) == 2) short_legs |= bit(x); else if(degree(x) > 2) long_legs |= bit(x);
+      if(__builtin_popcountll(short_legs) + __builtin_popcountll(long_legs) < 3) continue;
+      claw[0] = c;
+      uint legs = 0;
+      FOR_BITS(x, short_legs) if(legs < 3) {
+        claw[2 * legs + 1] = x;
+        claw[2 * legs + 2] = __builtin_ctzll(adj[x] & ~bit(c));
+        ++legs;
+      }
+      FOR_BITS(x, long_legs) if(legs < 3) {
+        claw[2 * legs + 1] = x;
+        claw[2 * legs + 2] = __builtin_ctzll(adj[x] & ~bit(c));
+        ++legs;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool small_graph::get_obstruction(vector<small_edge>& edges) const{
+    edges.clear();
+    uint t[3];
+    if(find_triangle(t)){
+      edges.push_back(small_edge(t[0], t[1]));
+      edges.push_back(small_edge(t[1], t[2]));
+      edges.push_back(small_edge(t[2], t[0]));
+      return true;
+    }
+    // take the smaller of a shortest cycle and a 2-claw (6 edges); if we get to look for the 2-claw, then there are no
+    // cycles of length 3 or 4, as find_2claw() requires
+    vector<uint> cycle;
+    const bool has_cycle(find_short_cycle(cycle));
+    uint claw[7];
+    if((!has_cycle || (cycle.size() > 6)) && find_2claw(claw)){
+      for(uint i = 1; i < 7; i += 2){
+        edges.push_back(small_edge(claw[0], claw[i]));
+        edges.push_back(small_edge(claw[i], claw[i + 1]));
+      }
+      return true;
+    }
+    if(has_cycle){
+      for(uint i = 0; i < cycle.size(); ++i) edges.push_back(small_edge(cycle[i], cycle[(i + 1) % cycle.size()]));
+      return true;
+    }
+    return false;
+  }
+
+}
@@ -0,0 +1,70 @@
+#ifndef SMALL_GRAPH_HPP
+#define SMALL_GRAPH_HPP
+
+#include <stdint.h>
+#include "graphs.hpp"
+
+namespace cr {
+
+  // a graph on at most 64 vertices whose adjacency is kept as one machine word per vertex
+  // close to the leaves of the search tree, the components have a few dozen vertices and the list-based graph spends
+  // most of its time chasing handles; here, every neighborhood query is an AND and a popcount
+  class small_graph {
+  public:
+    typedef uint64_t row_t;
+    static const uint max_vertices = 64;
+
+    // an edge, given by the bits of its ends
+    typedef pair<uint, uint> small_edge;
+
+    // the number of vertices, they are the bits 0 to n-1
+    uint n;
+    // adj[u] has bit v set iff uv is an edge
+    row_t adj[max_vertices];
+    // permanent[u] has bit v set iff uv is an edge that may not be deleted
+    row_t permanent[max_vertices];
+    // the vertex of the original graph represented by each bit
+    vector<vertex_p> vertex_of;
+
+    // copy g, which must not have more than max_vertices vertices
+    explicit small_graph(graph& g);
+
+    inline static row_t bit(const uint v) {return (row_t)1 << v;}
+    inline uint degree(const uint v) const {return __builtin_popcountll(adj[v]);}
+
+    inline void delete_edge(const uint u, const uint v) {adj[u] &= ~bit(v); adj[v] &= ~bit(u);}
+    inline void add_edge(const uint u, const uint v) {adj[u] |= bit(v); adj[v] |= bit(u);}
+    inline void mark_permanent(const uint u, const uint v, const bool mark = true){
+      if(mark) {permanent[u] |= bit(v); permanent[v] |= bit(u);}
+      else {permanent[u] &= ~bit(v); permanent[v] &= ~bit(u);}
+    }
+    inline bool is_permanent(const uint u, const uint v) const {return permanent[u] & bit(v);}
+
+    uint num_edges() const;
+    uint num_components() const;
+    // the size of a feedback edge set, which is a lower bound on the size of any solution
+    inline uint fes_size() const {return num_edges() + num_components() - n;}
+    // the lower bound of star_packing() in bounds.cpp: each 2-star with r > 2 edge-disjoint rays needs r - 2 deletions,
+    // and the edges of no star need an FES
+    uint star_packing() const;
+
+    // find a triangle and write its corners to t
+    bool find_triangle(uint t[3]) const;
+    // find a shortest cycle of length at most max_len and write its vertices to cycle, in order
+    bool find_short_cycle(vector<uint>& cycle, const uint max_len = max_vertices) const;
+    // find a 2-claw (a center with three legs of length 2) and write it to claw as center, x1, y1, x2, y2, x3, y3
+    // CAUTION: this assumes that there are no cycles of length 3 or 4
+    bool find_2claw(uint claw[7]) const;
+
+    // get the edges of a smallest obstruction (cycle or 2-claw) to being a caterpillar forest
+    // return false if there is none
+    bool get_obstruction(vector<small_edge>& edges) const;
+    inline bool is_caterpillar_forest() const {
+      vector<small_edge> tmp;
+      return !get_obstruction(tmp);
+    }
+  };
+
+}
+
+#endif
@@ -18,6 +18,7 @@ float get_bnum_from_ST(const uint size, const uint depth){
   return (lower + upper)/2;
 }
 
+namespace cr{
 ostream& operator<<(ostream& os, const cr::stats_t& stat){
   os << "=== statistics: ==="<<endl;
   os << "fes: "<<stat.input_FES<< " ST nodes: "<<stat.searchtree_nodes<< " ST depth: "<<stat.searchtree_depth<<endl;
@@ -31,6 +32,7 @@ ostream& operator<<(ostream& os, const cr::stats_t& stat){
   os << "branching number from ST-size vs fes: "<< get_bnum_from_ST(stat.searchtree_nodes, stat.input_FES) << endl;
   return os;
 }
+}
 
 void output_parser_friendly(ostream& os, cr::stats_t& stat){
   os << stat.input_vertices << '\t' << stat.input_edges << '\t' << stat.input_FES<< '\t' << stat.searchtree_nodes << '\t' << stat.searchtree_depth << '\t' << stat.reduct_application[cr::TRR1] << '\t'<< stat.reduct_application[cr::TRR2] << '\t'<< stat.reduct_application[cr::TRR3] << '\t'<< stat.reduct_application[cr::TRR4] << '\t'<< stat.reduct_application[cr::TRR5] << '\t'<< stat.reduct_application[cr::TRR6] << '\t'<<stat.reduct_application[cr::PRR1] << '\t'<< stat.reduct_application[cr::PRR2] << '\t'<< stat.reduct_application[cr::PRR3] << '\t'<< stat.reduct_application[cr::PRR4] << '\t'<< stat.reduct_application[cr::PRR5] << '\t'<< stat.reduct_application[cr::PRR6] << '\t'<< stat.reduct_application[cr::PRR7] << '\t' << stat.reduct_application[cr::Fin] <<  '\t' << stat.reduct_application[cr::YL] << '\t'<< stat.bnum_avg[cr::Triangle].first << '\t' << stat.bnum_avg[cr::Triangle].second << '\t'<< stat.bnum_avg[cr::Claw0].first << '\t' << stat.bnum_avg[cr::Claw0].second << '\t'<< stat.bnum_avg[cr::Claw1].first << '\t' << stat.bnum_avg[cr::Claw1].second << '\t'<< stat.bnum_avg[cr::Claw2].first << '\t' << stat.bnum_avg[cr::Claw2].second << '\t'<< stat.bnum_avg[cr::Claw3].first << '\t' << stat.bnum_avg[cr::Claw3].second << '\t'<< stat.bnum_avg[cr::Deg2Path].first << '\t' << stat.bnum_avg[cr::Deg2Path].second << '\t'<<stat.bnum_avg[cr::Token].first << '\t' << stat.bnum_avg[cr::Token].second << '\t'<< stat.bnum_avg[cr::Bbridge].first << '\t' << stat.bnum_avg[cr::Bbridge].second << '\t' << stat.get_avg_bnum() << endl;
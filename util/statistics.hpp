@@ -50,6 +50,13 @@ namespace cr {
       input_FES = get_FES(g);
     }
 
+    // start over for the next instance, keeping the memory of the maps
+    void clear(){
+      input_vertices = input_edges = input_FES = searchtree_nodes = searchtree_depth = 0;
+      reduct_application.clear();
+      bnum_avg.clear();
+    }
+
     // add the application of a branching rule of type t and branching vector b_vec to the statistic
     void add_BRule(const branch_type& t, const uint* b_vec, const uint entries){
       pair<uint, float>& entry(bnum_avg[t]);
@@ -70,7 +77,9 @@ namespace cr {
 
 }
 
-ostream& operator<<(ostream& os, const cr::stats_t& stat);
+namespace cr{
+  ostream& operator<<(ostream& os, const cr::stats_t& stat);
+}
 
 void output_parser_friendly(ostream& os, cr::stats_t& stat);
 